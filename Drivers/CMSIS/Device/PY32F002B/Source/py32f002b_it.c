@@ -72,6 +72,7 @@ void PendSV_Handler(void)
   */
 void SysTick_Handler(void)
 {
+  systick_irq_handler();
 }
 
 /******************************************************************************/
@@ -500,8 +500,7 @@ int rtt_printf(const char * sFormat, ...) {
 
 void print_timestamp(void)
 {
-    uint64_t timestamp_us = clock_time();
-    timestamp_us *= 2;
+    uint64_t timestamp_us = clock_time64();
     uint32_t total_seconds = timestamp_us / 1000000; // ???????
     uint32_t microseconds = timestamp_us % 1000000;  // ?????
 
@@ -62,6 +62,13 @@ extern "C" {
 /* Max delay can be used in LL_mDelay */
 #define LL_MAX_DELAY                  0xFFFFFFFFU
 
+/* Core cycles per timebase unit, SysTick runs from HCLK = 48MHz */
+#define CLOCK_SYS_TICKS_PER_US        48U
+#define CLOCK_SYS_TICKS_PER_MS        (CLOCK_SYS_TICKS_PER_US * 1000U)
+
+/* ticks / 48 as (ticks * ceil(2^21 / 48)) >> 21, exact for ticks < 131072 */
+#define CLOCK_TICKS_TO_US(ticks)      (((uint32_t)(ticks) * 43691U) >> 21)
+
 /**
  * @brief Unique device ID register base address
  */
@@ -212,8 +219,15 @@ void                LL_Init1msTick(uint32_t HCLKFrequency);
 void                LL_mDelay(uint32_t Delay);
 
 extern void         systick_init(void);
+extern void         systick_irq_handler(void);
+extern void         systick_advance_ms(uint32_t ms);
+extern uint64_t     clock_time64(void);
 extern uint32_t     clock_time(void);
-extern _Bool        clock_time_exceed(uint32_t start_time, uint32_t timeout_ms);
+extern uint32_t     clock_time_ms(void);
+extern _Bool        clock_time_exceed(uint32_t start_time, uint32_t timeout_us);
+extern _Bool        clock_time_exceed_ms(uint32_t start_time, uint32_t timeout_ms);
+#define             clock_time_us()                     clock_time()
+#define             clock_time_exceed_us(start, timeout) clock_time_exceed((start), (timeout))
 extern void         WaitUs(uint32_t Delay); 
 extern void         WaitMs(uint32_t Delay);
 
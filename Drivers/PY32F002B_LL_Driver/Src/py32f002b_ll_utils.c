@@ -136,49 +136,116 @@ void LL_mDelay(uint32_t Delay)
 }
 
 /**
- * @brief Initialize SysTick as a free-running counter without enabling interrupts.
- * 
- * This function configures the SysTick timer to run freely without generating interrupts.
- * It sets the SysTick to use the core clock (48 MHz) and enables the counter.
+ * @brief Milliseconds elapsed since systick_init(), advanced by SysTick_Handler.
+ */
+static volatile uint64_t systick_ms = 0;
+
+/**
+ * @brief Initialize SysTick as the 1 ms system timebase.
+ *
+ * SysTick reloads every CLOCK_SYS_TICKS_PER_MS core cycles and its interrupt
+ * advances the 64-bit millisecond counter, so the timebase never depends on
+ * how often clock_time() is polled.
  */
 void systick_init(void)
 {
-  SysTick->LOAD = 0xFFFFFF;  
-  SysTick->VAL = 0;          
-  SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk |  
-                  SysTick_CTRL_ENABLE_Msk;      
+  systick_ms = 0;
+  SysTick_Config(CLOCK_SYS_TICKS_PER_MS);
+  /* above the RF TIM1 interrupt, which keeps the lowest level */
+  NVIC_SetPriority(SysTick_IRQn, 2);
 }
 
 /**
- * @brief Get the current system time in milliseconds.
- * @return Current timestamp as a 32-bit unsigned integer.
+ * @brief SysTick overflow handler, called from SysTick_Handler every 1 ms.
+ */
+void systick_irq_handler(void)
+{
+  systick_ms++;
+}
+
+/**
+ * @brief Credit time the core spent with SysTick stopped (STOP mode).
+ * @param ms Milliseconds to add to the timebase.
+ */
+void systick_advance_ms(uint32_t ms)
+{
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  systick_ms += ms;
+  __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Get the current system time in microseconds.
+ *
+ * The millisecond count and the SysTick down-counter are sampled together and
+ * re-read if the interrupt fired in between. A reload that is pending while
+ * interrupts are masked is folded in by hand, so the result stays monotonic
+ * inside critical sections too. The sub-millisecond part is converted with a
+ * multiply and shift instead of a divide.
+ * @return Current timestamp in microseconds as a 64-bit unsigned integer.
+ */
+uint64_t clock_time64(void)
+{
+  uint64_t ms;
+  uint32_t val;
+  uint32_t pending;
+
+  do
+  {
+    ms      = systick_ms;
+    val     = SysTick->VAL;
+    pending = SCB->ICSR & SCB_ICSR_PENDSTSET_Msk;
+  } while (ms != systick_ms);
+
+  if (pending)
+  {
+    val = SysTick->VAL;
+    ms++;
+  }
+
+  return ms * 1000U + CLOCK_TICKS_TO_US((CLOCK_SYS_TICKS_PER_MS - 1U) - val);
+}
+
+/**
+ * @brief Get the current system time in microseconds.
+ * @return Lower 32 bits of clock_time64(), wraps every ~71.6 minutes.
  */
 uint32_t clock_time(void)
 {
-  static uint32_t overflow_count = 0;  
-  static uint32_t last_value = 0;     
-  
-  uint32_t current_value = SysTick->VAL & 0xFFFFFF;  
-  
-  if (current_value > last_value) 
-    overflow_count++;  
-  
-  last_value = current_value;
-  
-  uint32_t ticks_per_ms = 48;  
-  uint64_t total_ticks = (uint64_t)overflow_count * 0x1000000 + (0xFFFFFF - current_value);
-  return (uint32_t)(total_ticks / ticks_per_ms);
+  return (uint32_t)clock_time64();
+}
+
+/**
+ * @brief Get the current system time in milliseconds.
+ * @return Millisecond count since systick_init(), wraps every ~49.7 days.
+ */
+uint32_t clock_time_ms(void)
+{
+  return (uint32_t)systick_ms;
 }
 
 /**
  * @brief Check if the time has exceeded the timeout threshold.
  * @param start_time The recorded start time (obtained by clock_time()).
+ * @param timeout_us The timeout threshold (unit: microseconds).
+ * @return 1 if timeout has occurred, 0 if not.
+ */
+_Bool clock_time_exceed(uint32_t start_time, uint32_t timeout_us)
+{
+  return ((clock_time() - start_time) >= timeout_us);
+}
+
+/**
+ * @brief Check if the time has exceeded the timeout threshold.
+ * @param start_time The recorded start time (obtained by clock_time_ms()).
  * @param timeout_ms The timeout threshold (unit: milliseconds).
  * @return 1 if timeout has occurred, 0 if not.
  */
-_Bool clock_time_exceed(uint32_t start_time, uint32_t timeout_ms)
+_Bool clock_time_exceed_ms(uint32_t start_time, uint32_t timeout_ms)
 {
-    return (((uint32_t)clock_time() - start_time) >= timeout_ms);
+  return ((clock_time_ms() - start_time) >= timeout_ms);
 }
 
 void WaitUs(uint32_t Delay) 
@@ -0,0 +1,82 @@
+/*********************************************************************************************************
+ * @file      host_app_stub.c
+ * @brief     Host stand-ins below app.c: the RF driver and the module inits.
+ * @details   Every frame queued on the RF driver is logged in host_frame_log
+ *            instead of sent. Only linked by tests that build app.c.
+ ********************************************************************************************************/
+
+/*============================================================================*
+ *                              Header Files
+ *============================================================================*/
+#include <string.h>
+#include "host_test.h"
+#include "main.h"
+#include "app.h"
+#include "function_handle.h"
+
+/*============================================================================*
+ *                              Global Variables
+ *============================================================================*/
+Host_frame_t host_frame_log[HOST_FRAME_LOG_SIZE];
+uint16_t host_frame_num = 0;
+_Bool host_rf_queue_full = 0;
+
+/*============================================================================*
+ *                              Function Definitions
+ *============================================================================*/
+void host_frame_log_clear(void)
+{
+    host_frame_num = 0;
+}
+
+static void host_frame_log_add(const Send_packet_t *p_packet, uint8_t repeat)
+{
+    Host_frame_t *p_frame;
+
+    if (host_frame_num >= HOST_FRAME_LOG_SIZE)
+        return;
+
+    p_frame = &host_frame_log[host_frame_num++];
+    p_frame->time_ms = (uint32_t)(host_time_us / 1000);
+    p_frame->type = p_packet ? p_packet->type : 0;
+    p_frame->command = p_packet ? p_packet->data[0] : 0;
+    p_frame->repeat = repeat;
+}
+
+/* 433_send_driver.c, frames are copied on queueing as the driver does */
+_Bool rf_send_repeat(uint8_t *data, uint8_t len, uint8_t repeat)
+{
+    Send_packet_t packet;
+
+    if (len != sizeof(packet) || repeat == 0 || host_rf_queue_full)
+        return 0;
+
+    memcpy(&packet, data, len);
+    host_frame_log_add(&packet, repeat);
+    return 1;
+}
+
+void rf_send_cancel(void)
+{
+    host_frame_log_add(0, 0);
+}
+
+bool rf_send_is_working(void)
+{
+    return false;
+}
+
+/* inits and tasks app.c refers to, weak so a test may link the real module */
+__attribute__((weak)) void BSP_RCC_HSI_48MConfig(void) {}
+__attribute__((weak)) void systick_init(void) {}
+__attribute__((weak)) void led_init(void) {}
+__attribute__((weak)) void dev_iic_config(void) {}
+__attribute__((weak)) void qmi8658a_setup_init(void) {}
+__attribute__((weak)) void qmi8658a_loop(void) {}
+__attribute__((weak)) void device_pair_id_read() {}
+__attribute__((weak)) void keybroad_init(void) {}
+__attribute__((weak)) void key_action_init(void) {}
+__attribute__((weak)) void keyboard_loop(void) {}
+__attribute__((weak)) void rf_driver_init(void) {}
+__attribute__((weak)) void task_scheduler_init(Task_item_t *list, uint8_t num) {}
+__attribute__((weak)) void task_scheduler_run(void) {}
@@ -0,0 +1,110 @@
+/*********************************************************************************************************
+ * @file      host_stub.c
+ * @brief     Host stand-ins for the hardware bound firmware functions.
+ * @details   SysTick is replaced by a virtual clock the tests advance by hand,
+ *            and the scheduler, EXTI and LED calls do nothing.
+ ********************************************************************************************************/
+
+/*============================================================================*
+ *                              Header Files
+ *============================================================================*/
+#include <stdarg.h>
+#include "host_test.h"
+#include "main.h"
+#include "app.h"
+
+/*============================================================================*
+ *                              Global Variables
+ *============================================================================*/
+uint64_t host_time_us = 1000000;        // clock_time() | 1 is never 0 in the firmware
+int host_test_failed = 0;
+
+/*============================================================================*
+ *                              Function Definitions
+ *============================================================================*/
+void host_time_advance_us(uint32_t us)
+{
+    host_time_us += us;
+}
+
+/**
+ * @brief  Prints the test verdict.
+ * @param  name: Test name.
+ * @retval Process exit code, 0 when every check passed.
+ */
+int host_test_result(const char *name)
+{
+    fprintf(stderr, "%s: %s (%d failed checks)\n", name, host_test_failed ? "FAIL" : "PASS", host_test_failed);
+    return host_test_failed ? 1 : 0;
+}
+
+/* py32f002b_ll_utils.c */
+uint64_t clock_time64(void)
+{
+    return host_time_us;
+}
+
+uint32_t clock_time(void)
+{
+    return (uint32_t)host_time_us;
+}
+
+uint32_t clock_time_ms(void)
+{
+    return (uint32_t)(host_time_us / 1000);
+}
+
+_Bool clock_time_exceed(uint32_t start_time, uint32_t timeout_us)
+{
+    return ((clock_time() - start_time) >= timeout_us);
+}
+
+_Bool clock_time_exceed_ms(uint32_t start_time, uint32_t timeout_ms)
+{
+    return ((clock_time_ms() - start_time) >= timeout_ms);
+}
+
+void systick_advance_ms(uint32_t ms)
+{
+    host_time_us += (uint64_t)ms * 1000;
+}
+
+/* SEGGER_RTT_printf.c */
+int rtt_printf(const char *sFormat, ...)
+{
+    va_list args;
+    int r;
+
+    va_start(args, sFormat);
+    r = vfprintf(stdout, sFormat, args);
+    va_end(args);
+    return r;
+}
+
+/* py32f002b_ll_exti.c */
+uint32_t LL_EXTI_Init(LL_EXTI_InitTypeDef *EXTI_InitStruct)
+{
+    (void)EXTI_InitStruct;
+    return 0;
+}
+
+/* task_handle.c */
+void task_set_ready(uint8_t task_id)
+{
+    (void)task_id;
+}
+
+void task_set_period(uint8_t task_id, uint16_t period_ms)
+{
+    (void)task_id;
+    (void)period_ms;
+}
+
+/* led_driver.c */
+void led_open(void)
+{
+}
+
+void led_close(void)
+{
+}
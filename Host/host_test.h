@@ -0,0 +1,64 @@
+/*********************************************************************************************************
+ * @file      host_test.h
+ * @brief     Checks and simulated hardware shared by the host tests.
+ * @details   The firmware modules are linked against host_stub.c, which keeps
+ *            a virtual microsecond clock and logs the frames queued on RF.
+ * @note      Include ahead of the firmware headers: with DEBUG_ENABLED off
+ *            py32f002b_bsp_printf.h renames printf, which breaks <stdio.h>.
+ ********************************************************************************************************/
+
+#ifndef _HOST_TEST_H_
+#define _HOST_TEST_H_
+
+/*============================================================================*
+ *                              Header Files
+ *============================================================================*/
+#include <stdint.h>
+#include <stdio.h>
+
+/*============================================================================*
+ *                        Export Global Variables
+ *============================================================================*/
+typedef struct
+{
+    uint32_t time_ms;                   // virtual time of the request
+    uint8_t type;                       // Send_packet_t.type
+    uint8_t command;                    // Send_packet_t.data[0]
+    uint8_t repeat;                     // transmissions queued, 0 for a cancel
+} Host_frame_t;
+
+#define HOST_FRAME_LOG_SIZE             256
+
+extern uint64_t host_time_us;
+extern Host_frame_t host_frame_log[HOST_FRAME_LOG_SIZE];
+extern uint16_t host_frame_num;
+extern _Bool host_rf_queue_full;
+extern int host_test_failed;
+
+#define HOST_CHECK(cond)                                                        \
+    do {                                                                        \
+        if (!(cond))                                                            \
+        {                                                                       \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            host_test_failed++;                                                 \
+        }                                                                       \
+    } while (0)
+
+#define HOST_CHECK_EQ(a, b)                                                     \
+    do {                                                                        \
+        long _a = (long)(a), _b = (long)(b);                                    \
+        if (_a != _b)                                                           \
+        {                                                                       \
+            fprintf(stderr, "%s:%d: check failed: %s == %s (%ld != %ld)\n",     \
+                    __FILE__, __LINE__, #a, #b, _a, _b);                        \
+            host_test_failed++;                                                 \
+        }                                                                       \
+    } while (0)
+
+/*============================================================================*
+ *                      Extern Functions
+ *============================================================================*/
+extern void host_time_advance_us(uint32_t us);
+extern void host_frame_log_clear(void);
+extern int host_test_result(const char *name);
+#endif
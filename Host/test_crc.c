@@ -0,0 +1,89 @@
+/*********************************************************************************************************
+ * @file      test_crc.c
+ * @brief     Packet check values against a bitwise reference.
+ * @details   Built once per PACKET_CRC8_FULL_TABLE / PACKET_CHECK_MODE variant.
+ ********************************************************************************************************/
+
+/*============================================================================*
+ *                              Header Files
+ *============================================================================*/
+#include <stddef.h>
+#include <string.h>
+#include "host_test.h"
+#include "function_handle.h"
+
+/*============================================================================*
+ *                              Function Definitions
+ *============================================================================*/
+/* CRC-8 poly 0x07, init 0x00, one bit at a time */
+static uint8_t crc8_ref(const uint8_t *data, uint8_t length)
+{
+    uint8_t crc = 0x00;
+
+    for (uint8_t i = 0; i < length; i++)
+    {
+        crc ^= data[i];
+        for (uint8_t b = 0; b < 8; b++)
+            crc = (crc & 0x80) ? (uint8_t)(crc << 1) ^ 0x07 : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+static void test_crc8_vectors(void)
+{
+    const uint8_t check[] = "123456789";
+    uint8_t buf[16];
+    uint32_t seed = 1;
+
+    // CRC-8/SMBUS check value
+    HOST_CHECK_EQ(crc8(check, 9), 0xF4);
+    HOST_CHECK_EQ(crc8(check, 0), 0x00);
+
+    for (uint16_t b = 0; b < 256; b++)
+    {
+        buf[0] = (uint8_t)b;
+        HOST_CHECK_EQ(crc8(buf, 1), crc8_ref(buf, 1));
+    }
+
+    for (uint16_t n = 0; n < 1000; n++)
+    {
+        uint8_t len = 1 + n % sizeof(buf);
+
+        for (uint8_t i = 0; i < len; i++)
+        {
+            seed = seed * 1103515245U + 12345U;
+            buf[i] = (uint8_t)(seed >> 16);
+        }
+        HOST_CHECK_EQ(crc8(buf, len), crc8_ref(buf, len));
+    }
+}
+
+static void test_packet_check(void)
+{
+    Send_packet_t packet;
+    uint8_t expect;
+
+    memset(&packet, 0, sizeof(packet));
+    packet.device_id[0] = 0x11;
+    packet.device_id[1] = 0x22;
+    packet.device_id[2] = 0x33;
+    packet.type = NTC_TYPE;
+    packet.data[0] = 0x0A;
+    packet.data[1] = 0x00;
+    packet.data[2] = 25;
+    packet.data[3] = 5;
+
+#if (PACKET_CHECK_MODE == PACKET_CHECK_CRC8)
+    expect = crc8_ref((const uint8_t *)&packet, offsetof(Send_packet_t, dat_check));
+#else
+    PACKET_CHECK(expect, packet.data[0], packet.data[1], packet.data[2], packet.data[3]);
+#endif
+    HOST_CHECK_EQ(packet_check_calc(&packet), expect);
+}
+
+int main(void)
+{
+    test_crc8_vectors();
+    test_packet_check();
+    return host_test_result("test_crc");
+}
@@ -0,0 +1,150 @@
+/*********************************************************************************************************
+ * @file      test_keyboard_driver.c
+ * @brief     Debounce, ghost mask and event queue of the key scanner.
+ * @details   The driver is included so its static helpers can be called
+ *            directly; nothing here touches the GPIO registers.
+ ********************************************************************************************************/
+
+/*============================================================================*
+ *                              Header Files
+ *============================================================================*/
+#include "host_test.h"
+#include "keyboard_driver.c"
+
+/*============================================================================*
+ *                              Function Definitions
+ *============================================================================*/
+#define KEYS            (ARRAY_SIZE(row_pin) * ARRAY_SIZE(col_pin))
+
+/* as keybroad_init() leaves it */
+static void kb_debounce_reset(void)
+{
+    memset(&kb_debounce, 0, sizeof(kb_debounce));
+    for (uint8_t k = 0; k < ARRAY_SIZE(kb_debounce.cnt); k++)
+        kb_debounce.cnt[k] = (KB_DEBOUNCE_SAMPLES & (1 << k)) ? (Kb_bitboard_t)~0 : 0;
+}
+
+static void test_debounce(void)
+{
+    const Kb_bitboard_t a = BIT(5);
+    const Kb_bitboard_t b = BIT(10);
+    Kb_bitboard_t changed;
+
+    kb_debounce_reset();
+
+    // a press is reported on its KB_DEBOUNCE_SAMPLES-th consecutive sample
+    for (uint8_t n = 1; n < KB_DEBOUNCE_SAMPLES; n++)
+        HOST_CHECK_EQ(kb_debounce_update(a), 0);
+    HOST_CHECK_EQ(kb_debounce_update(a), a);
+    HOST_CHECK_EQ(kb_debounce.stable, a);
+    HOST_CHECK_EQ(kb_debounce_update(a), 0);
+
+    // one open sample restarts the release count
+    for (uint8_t n = 1; n < KB_DEBOUNCE_SAMPLES; n++)
+        HOST_CHECK_EQ(kb_debounce_update(0), 0);
+    HOST_CHECK_EQ(kb_debounce_update(a), 0);
+    for (uint8_t n = 1; n < KB_DEBOUNCE_SAMPLES; n++)
+        HOST_CHECK_EQ(kb_debounce_update(0), 0);
+    HOST_CHECK_EQ(kb_debounce_update(0), a);
+    HOST_CHECK_EQ(kb_debounce.stable, 0);
+
+    // keys count independently
+    changed = 0;
+    for (uint8_t n = 0; n < KB_DEBOUNCE_SAMPLES + 2; n++)
+    {
+        Kb_bitboard_t toggle = kb_debounce_update(a | ((n >= 2) ? b : 0));
+
+        if (n == KB_DEBOUNCE_SAMPLES - 1)
+            HOST_CHECK_EQ(toggle, a);
+        else if (n == KB_DEBOUNCE_SAMPLES + 1)
+            HOST_CHECK_EQ(toggle, b);
+        else
+            HOST_CHECK_EQ(toggle, 0);
+        changed |= toggle;
+    }
+    HOST_CHECK_EQ(changed, a | b);
+    HOST_CHECK_EQ(kb_debounce.stable, a | b);
+
+    // a single sample glitch on an idle key is never reported
+    kb_debounce_reset();
+    for (uint8_t n = 0; n < 4 * KB_DEBOUNCE_SAMPLES; n++)
+        HOST_CHECK_EQ(kb_debounce_update((n % 2) ? a : 0), 0);
+}
+
+/* What the diode-less matrix reads: a closed rectangle corner pair in one row
+ * connects every column it shares with another closed row. */
+static Kb_bitboard_t kb_matrix_sample(Kb_bitboard_t keys)
+{
+    const uint8_t cols = ARRAY_SIZE(col_pin);
+    const Kb_bitboard_t row_mask = (1U << cols) - 1;
+    Kb_bitboard_t sample = keys;
+    Kb_bitboard_t last;
+
+    do
+    {
+        last = sample;
+        for (uint8_t r1 = 0; r1 < ARRAY_SIZE(row_pin); r1++)
+            for (uint8_t r2 = 0; r2 < ARRAY_SIZE(row_pin); r2++)
+            {
+                Kb_bitboard_t row1 = (sample >> (r1 * cols)) & row_mask;
+                Kb_bitboard_t row2 = (sample >> (r2 * cols)) & row_mask;
+
+                if (r1 != r2 && (row1 & row2))
+                    sample |= row2 << (r1 * cols);
+            }
+    } while (sample != last);
+
+    return sample;
+}
+
+static void test_ghost_mask(void)
+{
+    for (uint8_t k1 = 0; k1 < KEYS; k1++)
+        for (uint8_t k2 = k1 + 1; k2 < KEYS; k2++)
+        {
+            // two keys can never look like a third
+            HOST_CHECK_EQ(kb_ghost_mask(BIT(k1) | BIT(k2)), 0);
+
+            for (uint8_t k3 = k2 + 1; k3 < KEYS; k3++)
+            {
+                Kb_bitboard_t keys = BIT(k1) | BIT(k2) | BIT(k3);
+                Kb_bitboard_t sample = kb_matrix_sample(keys);
+                Kb_bitboard_t mask = kb_ghost_mask(sample);
+
+                if (sample == keys)
+                {
+                    HOST_CHECK_EQ(mask, 0);
+                }
+                else
+                {
+                    // the phantom and the three real corners are all held back
+                    HOST_CHECK_EQ(mask & sample, sample);
+                }
+            }
+        }
+}
+
+static void test_event_fifo(void)
+{
+    Kb_event_t evt;
+
+    for (uint8_t i = 0; i < KB_EVENT_FIFO_SIZE + 1; i++)
+        kb_event_put(i + 1, KB_EVENT_PRESS, i);
+
+    for (uint8_t i = 0; i < KB_EVENT_FIFO_SIZE; i++)
+    {
+        HOST_CHECK(kb_event_get(&evt));
+        HOST_CHECK_EQ(evt.code, i + 1);
+        HOST_CHECK_EQ(evt.time, i);
+    }
+    // the event past a full queue is dropped
+    HOST_CHECK(!kb_event_get(&evt));
+}
+
+int main(void)
+{
+    test_debounce();
+    test_ghost_mask();
+    test_event_fifo();
+    return host_test_result("test_keyboard_driver");
+}
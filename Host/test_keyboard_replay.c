@@ -0,0 +1,264 @@
+/*********************************************************************************************************
+ * @file      test_keyboard_replay.c
+ * @brief     Key gestures replayed through keyboard_loop() down to the RF frames.
+ * @details   Key events are fed in place of the matrix scanner, with the
+ *            KB_EVENT_HOLD the scanner emits after KB_HOLD_TIMEOUT. The tasks
+ *            run through app.c, and the frames queued on the RF driver are
+ *            compared with the expected ones.
+ ********************************************************************************************************/
+
+/*============================================================================*
+ *                              Header Files
+ *============================================================================*/
+#include <string.h>
+#include "host_test.h"
+#include "keyboard_handle.h"
+#include "function_handle.h"
+
+/*============================================================================*
+ *                              Global Variables
+ *============================================================================*/
+extern const uint8_t kb_list[KB_TATOL];
+
+static Kb_event_t replay_queue[KB_EVENT_FIFO_SIZE];
+static uint8_t replay_head = 0;
+static uint8_t replay_tail = 0;
+static uint8_t replay_held = 0;
+static uint32_t replay_change_time = 0;
+static _Bool replay_hold_sent = 0;
+
+#define FRAME_FULL              NTC_TYPE
+#if (PACKET_REPEAT_FLAG_ENABLE)
+#define FRAME_REPEAT            (NTC_TYPE | PACKET_REPEAT_FLAG)
+#else
+#define FRAME_REPEAT            NTC_TYPE
+#endif
+
+/*============================================================================*
+ *                              Function Definitions
+ *============================================================================*/
+/* keyboard_driver.c */
+uint8_t kb_matrix_scan(void)
+{
+    // the scanner reports a key held unchanged for KB_HOLD_TIMEOUT once
+    if (replay_held && !replay_hold_sent && clock_time_exceed(replay_change_time, KB_HOLD_TIMEOUT * 1000))
+    {
+        replay_hold_sent = 1;
+        replay_queue[replay_head++ & (KB_EVENT_FIFO_SIZE - 1)] = (Kb_event_t){.code = 0, .type = KB_EVENT_HOLD, .time = clock_time()};
+    }
+    return replay_held;
+}
+
+_Bool kb_event_get(Kb_event_t *p_event)
+{
+    if (replay_head == replay_tail)
+        return 0;
+
+    *p_event = replay_queue[replay_tail++ & (KB_EVENT_FIFO_SIZE - 1)];
+    return 1;
+}
+
+_Bool kb_scan_try_idle(void)
+{
+    return 0;
+}
+
+static void replay_event(uint8_t code, uint8_t type)
+{
+    replay_queue[replay_head++ & (KB_EVENT_FIFO_SIZE - 1)] = (Kb_event_t){.code = code, .type = type, .time = clock_time()};
+    replay_change_time = clock_time();
+    replay_hold_sent = 0;
+    if (type == KB_EVENT_PRESS)
+        replay_held++;
+    else if (type == KB_EVENT_RELEASE)
+        replay_held--;
+}
+
+/* runs the keyboard task for ms of virtual time */
+static void replay_run(uint32_t ms)
+{
+    for (uint32_t t = 0; t < ms; t += TASK_PERIOD_KEYBOARD)
+    {
+        keyboard_loop();
+        rf_send_loop();
+        host_time_advance_us(TASK_PERIOD_KEYBOARD * 1000);
+    }
+}
+
+static void replay_tap(uint8_t code, uint32_t hold_ms, uint32_t gap_ms)
+{
+    replay_event(code, KB_EVENT_PRESS);
+    replay_run(hold_ms);
+    replay_event(code, KB_EVENT_RELEASE);
+    replay_run(gap_ms);
+}
+
+static void replay_reset(void)
+{
+    replay_run(1000);
+    HOST_CHECK_EQ(replay_held, 0);
+    HOST_CHECK_EQ(kb_code.cnt, 0);
+    host_frame_log_clear();
+}
+
+static void check_frame(uint16_t i, uint8_t type, uint8_t command, uint8_t repeat)
+{
+    HOST_CHECK(i < host_frame_num);
+    if (i >= host_frame_num)
+        return;
+    HOST_CHECK_EQ(host_frame_log[i].command, command);
+    HOST_CHECK_EQ(host_frame_log[i].repeat, repeat);
+    if (repeat)
+        HOST_CHECK_EQ(host_frame_log[i].type, type);
+}
+
+static void test_single_tap(void)
+{
+    replay_reset();
+    replay_tap(KB_CODE_1, 80, 400);
+    HOST_CHECK_EQ(host_frame_num, 1);
+    check_frame(0, FRAME_FULL, kb_list[KB_CODE_1 - 1], RF_SINGLE_SEND_DATA_NUM);
+}
+
+static void test_fan_tap(void)
+{
+    uint32_t release;
+
+    // the tap waits for the double tap window to close
+    replay_reset();
+    replay_tap(KB_CODE_7, 80, 0);
+    release = clock_time_ms();
+    replay_run(KB_DOUBLE_TAP_WINDOW - 20);
+    HOST_CHECK_EQ(host_frame_num, 0);
+    replay_run(100);
+    HOST_CHECK_EQ(host_frame_num, 1);
+    check_frame(0, FRAME_FULL, FAN_SWITCH, RF_SINGLE_SEND_DATA_NUM);
+    HOST_CHECK(host_frame_log[0].time_ms - release >= KB_DOUBLE_TAP_WINDOW);
+}
+
+static void test_fan_double_tap(void)
+{
+    replay_reset();
+    replay_tap(KB_CODE_7, 80, 120);
+    replay_tap(KB_CODE_7, 80, 600);
+    HOST_CHECK_EQ(host_frame_num, 1);
+    check_frame(0, FRAME_FULL, REVERSIBLE, RF_SINGLE_SEND_DATA_NUM);
+}
+
+static void test_tap_then_other_key(void)
+{
+    // the next press flushes the pending tap and sends its own short press
+    // in the same pass, both frames must reach the RF queue
+    replay_reset();
+    replay_tap(KB_CODE_7, 80, 120);
+    replay_tap(KB_CODE_1, 80, 400);
+    HOST_CHECK_EQ(host_frame_num, 2);
+    check_frame(0, FRAME_FULL, FAN_SWITCH, RF_SINGLE_SEND_DATA_NUM);
+    check_frame(1, FRAME_FULL, kb_list[KB_CODE_1 - 1], RF_SINGLE_SEND_DATA_NUM);
+    if (host_frame_num == 2)
+        HOST_CHECK_EQ(host_frame_log[0].time_ms, host_frame_log[1].time_ms);
+}
+
+static void test_queue_full_retry(void)
+{
+    // a packet the RF queue has no room for is retried by rf_send_loop()
+    replay_reset();
+    host_rf_queue_full = 1;
+    replay_event(KB_CODE_1, KB_EVENT_PRESS);
+    replay_run(40);
+    HOST_CHECK_EQ(host_frame_num, 0);
+    host_rf_queue_full = 0;
+    replay_run(40);
+    replay_event(KB_CODE_1, KB_EVENT_RELEASE);
+    replay_run(40);
+    HOST_CHECK_EQ(host_frame_num, 1);
+    check_frame(0, FRAME_FULL, kb_list[KB_CODE_1 - 1], RF_SINGLE_SEND_DATA_NUM);
+}
+
+static void test_key_repeat(void)
+{
+    replay_reset();
+    replay_event(KB_CODE_10, KB_EVENT_PRESS);
+    replay_run(1000);
+    replay_event(KB_CODE_10, KB_EVENT_RELEASE);
+    replay_run(40);
+
+    // press, then KB_REPEAT_DELAY and an accelerating interval
+    HOST_CHECK(host_frame_num >= 5);
+    check_frame(0, FRAME_FULL, GEAR_ADD, RF_SINGLE_SEND_DATA_NUM);
+    for (uint16_t i = 1; i < host_frame_num; i++)
+        check_frame(i, FRAME_REPEAT, GEAR_ADD, RF_REPEAT_SEND_DATA_NUM);
+    if (host_frame_num >= 2)
+        HOST_CHECK(host_frame_log[1].time_ms - host_frame_log[0].time_ms >= KB_REPEAT_DELAY);
+}
+
+static void test_key_repeat_past_hold(void)
+{
+    uint32_t press;
+
+    // KB_GESTURE_LONG takes over the single key repeat at KB_HOLD_TIMEOUT
+    replay_reset();
+    press = clock_time_ms();
+    replay_event(KB_CODE_10, KB_EVENT_PRESS);
+    replay_run(KB_HOLD_TIMEOUT + 1400);
+    replay_event(KB_CODE_10, KB_EVENT_RELEASE);
+    replay_run(40);
+
+    HOST_CHECK(host_frame_num >= 2);
+    if (host_frame_num < 2)
+        return;
+    HOST_CHECK(host_frame_log[host_frame_num - 1].time_ms - press >= KB_HOLD_TIMEOUT + 1200);
+    for (uint16_t i = 2; i < host_frame_num; i++)
+    {
+        check_frame(i, FRAME_REPEAT, GEAR_ADD, RF_REPEAT_SEND_DATA_NUM);
+        HOST_CHECK(host_frame_log[i].time_ms - host_frame_log[i - 1].time_ms <= KB_REPEAT_INTERVAL + TASK_PERIOD_KEYBOARD);
+    }
+}
+
+static void test_chord_long(void)
+{
+    uint16_t pair = 0;
+
+    replay_reset();
+    replay_event(KB_CODE_7, KB_EVENT_PRESS);
+    replay_event(KB_CODE_9, KB_EVENT_PRESS);
+    replay_run(KB_HOLD_TIMEOUT + 1000);
+    replay_event(KB_CODE_7, KB_EVENT_RELEASE);
+    replay_event(KB_CODE_9, KB_EVENT_RELEASE);
+    replay_run(40);
+
+    // the pairing chord sends once per hold
+    for (uint16_t i = 0; i < host_frame_num; i++)
+        pair += (host_frame_log[i].command == NOTE_TO_DEVICE_PAIR && host_frame_log[i].repeat);
+    HOST_CHECK_EQ(pair, 1);
+}
+
+static void test_hold_release(void)
+{
+    replay_reset();
+    replay_event(KB_CODE_12, KB_EVENT_PRESS);
+    replay_run(KB_HOLD_TIMEOUT + 200);
+    replay_event(KB_CODE_12, KB_EVENT_RELEASE);
+    replay_run(40);
+
+    // the hold burst is cancelled on release
+    HOST_CHECK(host_frame_num >= 2);
+    check_frame(host_frame_num - 2, FRAME_FULL, RGB_HOLD, RF_SINGLE_SEND_DATA_NUM);
+    check_frame(host_frame_num - 1, 0, 0, 0);
+}
+
+int main(void)
+{
+    key_action_init();
+
+    test_single_tap();
+    test_fan_tap();
+    test_fan_double_tap();
+    test_tap_then_other_key();
+    test_queue_full_retry();
+    test_key_repeat();
+    test_key_repeat_past_hold();
+    test_chord_long();
+    test_hold_release();
+    return host_test_result("test_keyboard_replay");
+}
@@ -0,0 +1,111 @@
+/*********************************************************************************************************
+ * @file      test_wave.c
+ * @brief     433 MHz frame encoder against a level-by-level reference.
+ * @details   Checks the packed buffer of protocol_command_encode() and the
+ *            segments the TIM1 ISR pulls from protocol_wave_next_segment().
+ ********************************************************************************************************/
+
+/*============================================================================*
+ *                              Header Files
+ *============================================================================*/
+#include <string.h>
+#include "host_test.h"
+#include "433_protocol.h"
+
+/*============================================================================*
+ *                              Function Definitions
+ *============================================================================*/
+#define WAVE_MAX_LEVELS         (WM_PREFIX_LEN + MAX_CODE_SIZE * 16 + WM_STOP_LEN)
+
+static uint16_t wave_ref_put_byte(uint8_t *p_level, uint16_t n, uint8_t byte)
+{
+    // Manchester, MSB first: log 1 -> high low, log 0 -> low high
+    for (int8_t b = 7; b >= 0; b--)
+    {
+        p_level[n++] = (byte >> b) & 1;
+        p_level[n++] = !((byte >> b) & 1);
+    }
+    return n;
+}
+
+/* The frame written out one half-bit at a time */
+static uint16_t wave_ref(const uint8_t *data, uint8_t len, uint8_t *p_level)
+{
+    uint16_t n = 0;
+
+    for (uint8_t i = 0; i < WAKE_UP_CODE_LEN; i++)
+        n = wave_ref_put_byte(p_level, n, WM_WAKE_UP_CODE);
+
+    for (uint8_t i = 0; i < WM_HEADER_LEN; i++)
+        p_level[n++] = (i < 3);
+
+    p_level[n++] = 1;
+    p_level[n++] = 0;
+
+    for (uint8_t i = 0; i < len; i++)
+        n = wave_ref_put_byte(p_level, n, data[i]);
+
+    for (uint8_t i = 0; i < WM_STOP_LEN; i++)
+        p_level[n++] = 0;
+
+    return n;
+}
+
+static void test_wave_frame(const uint8_t *data, uint8_t len)
+{
+    uint8_t ref[WAVE_MAX_LEVELS];
+    uint16_t ref_len = wave_ref(data, len, ref);
+    T_WM_SEND_PARA para;
+    T_WM_WAVE wave;
+    uint16_t n = 0;
+
+    HOST_CHECK_EQ(ref_len, WM_PREFIX_LEN + len * 16 + WM_STOP_LEN);
+
+    // packed buffer, cleared first as wm_send_module_init() does
+    memset(&para, 0, sizeof(para));
+    HOST_CHECK_EQ(protocol_command_encode((uint8_t *)data, len, &para), IRDA_SUCCEED);
+    HOST_CHECK_EQ(para.send_buf_len, ref_len);
+    for (uint16_t i = 0; i < ref_len; i++)
+        HOST_CHECK_EQ((para.wm_send_buf[i >> 3] >> (7 - (i & 7))) & 1, ref[i]);
+
+    // on-the-fly segments, consumed like the TIM1 ISR does
+    HOST_CHECK_EQ(protocol_wave_start((uint8_t *)data, len, &wave), IRDA_SUCCEED);
+    while (protocol_wave_next_segment(&wave))
+    {
+        HOST_CHECK(wave.bit_cnt > 0 && wave.bit_cnt <= 16);
+        while (wave.bit_cnt)
+        {
+            if (n < ref_len)
+                HOST_CHECK_EQ(wave.shift >> 15, ref[n]);
+            n++;
+            wave.shift <<= 1;
+            wave.bit_cnt--;
+        }
+    }
+    HOST_CHECK_EQ(n, ref_len);
+}
+
+int main(void)
+{
+    uint8_t data[MAX_CODE_SIZE + 1];
+    T_WM_SEND_PARA para;
+    T_WM_WAVE wave;
+
+    for (uint8_t i = 0; i < sizeof(data); i++)
+        data[i] = (uint8_t)(0x11 * i + 0x5A);
+
+    for (uint8_t len = 0; len <= MAX_CODE_SIZE; len++)
+        test_wave_frame(data, len);
+
+    for (uint16_t b = 0; b < 256; b++)
+    {
+        data[0] = (uint8_t)b;
+        test_wave_frame(data, 1);
+    }
+
+    memset(&para, 0, sizeof(para));
+    HOST_CHECK_EQ(protocol_command_encode(data, MAX_CODE_SIZE + 1, &para), IRDA_DATA_ERROR);
+    HOST_CHECK_EQ(protocol_wave_start(data, MAX_CODE_SIZE + 1, &wave), IRDA_DATA_ERROR);
+
+    return host_test_result("test_wave");
+}
@@ -69,35 +69,44 @@ void device_status_loop(void)
 
 #if (UI_RF_ENABLE)
 /**
- * @brief   Continuously sends data over RF (Radio Frequency) connection.
- * @details This function runs in a loop, sending data packets at regular intervals
- *          over an RF interface. It is typically used for maintaining a steady stream
- *          of data transmission in applications such as wireless sensor networks,
- *          remote controls, etc.
+ * @brief   Retries a key packet the RF transmit queue had no room for, and
+ *          returns to idle once the transmitter has finished.
+ * @note    Only the latest packet waits here: a newer send while the queue is
+ *          still full replaces it.
  * @param  None
  * @retval None
  */
-void rf_send_loop()
+void rf_send_loop(void)
 {
     if (rf_send_st.send_status == SENDING_DATA)
     {
-        if (clock_time_exceed(rf_send_st.send_tick, RF_SEND_TIMEOUT * 1000))
+        if (rf_send_st.send_num)
         {
-            if (rf_send((uint8_t *)&packet_dat, sizeof(packet_dat)))
-            {
-                rf_send_st.send_tick = clock_time() | 1;
-                rf_send_st.send_num--;
-            }
+            if (rf_send_repeat((uint8_t *)&packet_dat, sizeof(packet_dat), rf_send_st.send_num))
+                rf_send_st.send_num = 0;
         }
-
-        if (rf_send_st.send_num == 0)
+        else if (!rf_send_is_working())
         {
-            if (!rf_send_is_working())
-                rf_send_st.send_status = SEND_IDLE;
+            rf_send_st.send_status = SEND_IDLE;
         }
     }
 }
 
+/**
+ * @brief  Starts sending the current packet a given number of times.
+ * @details The burst is queued right away, the RF queue keeps its own copy.
+ *          packet_dat is only a fill buffer: one scan pass may send a pending
+ *          tap and a new key press back to back.
+ * @param  num: Number of frames in the burst.
+ * @retval None
+ */
+void re_send_start(uint8_t num)
+{
+    rf_send_st.send_status = SENDING_DATA;
+    rf_send_st.send_num = rf_send_repeat((uint8_t *)&packet_dat, sizeof(packet_dat), num) ? 0 : num;
+    task_set_ready(TASK_ID_RF_SEND);
+}
+
 /**
  * @brief  Enables or disables the re-sending of data.
  * @param  enable: A boolean value indicating whether to enable (true) or disable (false)
@@ -108,19 +117,37 @@ void re_send_enable(_Bool enable)
 {
     if (enable)
     {
-        rf_send_st.send_tick = 0;
-        rf_send_st.send_status = SENDING_DATA;
-        rf_send_st.send_num = RF_SINGLE_SEND_DATA_NUM;
+        re_send_start(RF_SINGLE_SEND_DATA_NUM);
     }
     else
     {
-        rf_send_st.send_tick = 0;
+        rf_send_cancel();
         rf_send_st.send_status = SEND_IDLE;
         rf_send_st.send_num = 0;
     }
 }
 #endif
 
+/**
+ * @brief  Static task table, indexed by TASK_ID_xxx and run in this order.
+ */
+Task_item_t app_task_list[TASK_ID_NUM] =
+{
+    TASK_ITEM(device_status_loop, TASK_PERIOD_DEVICE_STATUS),
+#if (GYROSCOPE_ENABLE)
+    TASK_ITEM(qmi8658a_loop, TASK_PERIOD_EVENT),
+#endif
+#if (UI_KEYBOARD_ENABLE)
+    TASK_ITEM(keyboard_loop, TASK_PERIOD_KEYBOARD),
+#endif
+#if (LOW_POWER_ENABLE)
+    TASK_ITEM(app_enter_deepstop, TASK_PERIOD_LOW_POWER),
+#endif
+#if (UI_RF_ENABLE)
+    TASK_ITEM(rf_send_loop, TASK_PERIOD_RF_SEND),
+#endif
+};
+
 /**
  * @brief  Initializes the user-specific settings and configurations.
  *         This function is called once at the beginning of the program
@@ -159,6 +186,8 @@ void user_init(void)
 
 #if (UI_KEYBOARD_ENABLE)
     keybroad_init();
+
+    key_action_init();
 #endif
 
 #if (UI_RF_ENABLE)
@@ -170,31 +199,17 @@ void user_init(void)
 
     ntc_smapling(dev_st.device_temp);
 #endif
+
+    task_scheduler_init(app_task_list, TASK_ID_NUM);
 }
 
 /**
  * @brief  Main loop function that continuously executes the core logic of the application.
- *         This function is responsible for repeatedly processing tasks, checking for user input,
- *         updating system states, and handling events in a non-blocking manner.
+ *         Each call runs one pass of the task scheduler over app_task_list, which
+ *         executes the tasks that are due and then sleeps until the next deadline.
  * @retval None
  */
 void main_loop(void)
 {
-    device_status_loop();
-
-#if (GYROSCOPE_ENABLE)
-    qmi8658a_loop();
-#endif
-
-#if (UI_KEYBOARD_ENABLE)
-    keyboard_loop();
-#endif
-
-#if (LOW_POWER_ENABLE)
-    app_enter_deepstop();
-#endif
-
-#if (UI_RF_ENABLE)
-    rf_send_loop();
-#endif
-}
\ No newline at end of file
+    task_scheduler_run();
+}
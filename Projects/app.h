@@ -34,11 +34,35 @@
  *                           Export Global Variables
  *============================================================================*/
 #define RF_SINGLE_SEND_DATA_NUM                 5
-#define RF_SEND_TIMEOUT                         100 
+#define RF_REPEAT_SEND_DATA_NUM                 1
+#define RF_SEND_FRAME_GAP                       2000
 #define RCU_ENTER_SLEEP_TIMEOUT                 100
 #define KB_DITHER_TIMEOUT                       30
 #define KB_SHORT_TIMEOUT                        200
 
+#define TASK_PERIOD_DEVICE_STATUS               10
+#define TASK_PERIOD_KEYBOARD                    8
+#define TASK_PERIOD_LOW_POWER                   10
+#define TASK_PERIOD_RF_SEND                     10
+
+enum
+{
+    TASK_ID_DEVICE_STATUS,
+#if (GYROSCOPE_ENABLE)
+    TASK_ID_GYROSCOPE,
+#endif
+#if (UI_KEYBOARD_ENABLE)
+    TASK_ID_KEYBOARD,
+#endif
+#if (LOW_POWER_ENABLE)
+    TASK_ID_LOW_POWER,
+#endif
+#if (UI_RF_ENABLE)
+    TASK_ID_RF_SEND,
+#endif
+    TASK_ID_NUM
+};
+
 enum
 {
     POWER_ON,
@@ -70,7 +94,6 @@ typedef struct
 {
     _Bool send_status;
     uint8_t send_num;
-    uint32_t send_tick;
 }Rf_send_status_t;
 extern Rf_send_status_t rf_send_st;
 
@@ -83,4 +106,6 @@ extern void device_status_init(void);
 extern void device_status_loop(void);
 extern void device_status_clear(void);
 extern void re_send_enable(_Bool enable);
+extern void re_send_start(uint8_t num);
+extern void rf_send_loop(void);
 #endif
\ No newline at end of file
@@ -13,43 +13,180 @@
  *============================================================================*/
 #include "function_handle.h"
 #include "led_driver.h"
+#include "stddef.h"
+#if (PACKET_CHECK_MODE == PACKET_CHECK_CRC_HW)
+#include "py32f002b_ll_crc.h"
+#endif
 
 /*============================================================================*
  *                              Global Variables
  *============================================================================*/
 Send_packet_t packet_dat;
 
+#if (PACKET_CRC8_FULL_TABLE)
+/* CRC-8 poly 0x07, crc8_table[i] = CRC of the single byte i */
+static const uint8_t crc8_table[256] =
+{
+    0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15, 0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D,
+    0x70, 0x77, 0x7E, 0x79, 0x6C, 0x6B, 0x62, 0x65, 0x48, 0x4F, 0x46, 0x41, 0x54, 0x53, 0x5A, 0x5D,
+    0xE0, 0xE7, 0xEE, 0xE9, 0xFC, 0xFB, 0xF2, 0xF5, 0xD8, 0xDF, 0xD6, 0xD1, 0xC4, 0xC3, 0xCA, 0xCD,
+    0x90, 0x97, 0x9E, 0x99, 0x8C, 0x8B, 0x82, 0x85, 0xA8, 0xAF, 0xA6, 0xA1, 0xB4, 0xB3, 0xBA, 0xBD,
+    0xC7, 0xC0, 0xC9, 0xCE, 0xDB, 0xDC, 0xD5, 0xD2, 0xFF, 0xF8, 0xF1, 0xF6, 0xE3, 0xE4, 0xED, 0xEA,
+    0xB7, 0xB0, 0xB9, 0xBE, 0xAB, 0xAC, 0xA5, 0xA2, 0x8F, 0x88, 0x81, 0x86, 0x93, 0x94, 0x9D, 0x9A,
+    0x27, 0x20, 0x29, 0x2E, 0x3B, 0x3C, 0x35, 0x32, 0x1F, 0x18, 0x11, 0x16, 0x03, 0x04, 0x0D, 0x0A,
+    0x57, 0x50, 0x59, 0x5E, 0x4B, 0x4C, 0x45, 0x42, 0x6F, 0x68, 0x61, 0x66, 0x73, 0x74, 0x7D, 0x7A,
+    0x89, 0x8E, 0x87, 0x80, 0x95, 0x92, 0x9B, 0x9C, 0xB1, 0xB6, 0xBF, 0xB8, 0xAD, 0xAA, 0xA3, 0xA4,
+    0xF9, 0xFE, 0xF7, 0xF0, 0xE5, 0xE2, 0xEB, 0xEC, 0xC1, 0xC6, 0xCF, 0xC8, 0xDD, 0xDA, 0xD3, 0xD4,
+    0x69, 0x6E, 0x67, 0x60, 0x75, 0x72, 0x7B, 0x7C, 0x51, 0x56, 0x5F, 0x58, 0x4D, 0x4A, 0x43, 0x44,
+    0x19, 0x1E, 0x17, 0x10, 0x05, 0x02, 0x0B, 0x0C, 0x21, 0x26, 0x2F, 0x28, 0x3D, 0x3A, 0x33, 0x34,
+    0x4E, 0x49, 0x40, 0x47, 0x52, 0x55, 0x5C, 0x5B, 0x76, 0x71, 0x78, 0x7F, 0x6A, 0x6D, 0x64, 0x63,
+    0x3E, 0x39, 0x30, 0x37, 0x22, 0x25, 0x2C, 0x2B, 0x06, 0x01, 0x08, 0x0F, 0x1A, 0x1D, 0x14, 0x13,
+    0xAE, 0xA9, 0xA0, 0xA7, 0xB2, 0xB5, 0xBC, 0xBB, 0x96, 0x91, 0x98, 0x9F, 0x8A, 0x8D, 0x84, 0x83,
+    0xDE, 0xD9, 0xD0, 0xD7, 0xC2, 0xC5, 0xCC, 0xCB, 0xE6, 0xE1, 0xE8, 0xEF, 0xFA, 0xFD, 0xF4, 0xF3
+};
+#else
+/* CRC-8 poly 0x07, crc8_nibble[n] = (n << 4) shifted through the polynomial four times */
+static const uint8_t crc8_nibble[16] =
+{
+    0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15,
+    0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D
+};
+#endif
+
 /*============================================================================*
  *                              Function Definitions
  *============================================================================*/
 /**
- * @brief  Sends a packet containing data to be checked and set.
- * @param  data: Array of data to be sent, which may include various types of information.
- * @retval None
+ * @brief  Table driven CRC-8 (poly 0x07, init 0x00).
+ * @param  data: Buffer to check.
+ * @param  length: Number of bytes.
+ * @retval CRC-8 value.
  */
-void send_data_check_set(uint8_t data[])
+uint8_t crc8(const uint8_t *data, uint8_t length)
 {
-    data[4] = (data[0] ^ data[1] ^ data[2] ^ data[3]);
-    data[4] += 0x11;
+    uint8_t crc = 0x00;
+
+    for (uint8_t i = 0; i < length; i++)
+    {
+#if (PACKET_CRC8_FULL_TABLE)
+        crc = crc8_table[crc ^ data[i]];
+#else
+        crc ^= data[i];
+        crc = (uint8_t)(crc << 4) ^ crc8_nibble[crc >> 4];
+        crc = (uint8_t)(crc << 4) ^ crc8_nibble[crc >> 4];
+#endif
+    }
+    return crc;
 }
+
+#if (PACKET_CHECK_MODE == PACKET_CHECK_CRC_HW)
 /**
- * @brief  Sends a packet containing key press and temperature data.
+ * @brief  CRC of a buffer on the hardware CRC unit, folded to 8 bits.
+ * @details The unit only does CRC-32 (poly 0x04C11DB7, init 0xFFFFFFFF) on
+ *          32-bit writes, so bytes are fed big-endian four at a time and the
+ *          last word is zero padded. The 32-bit result is XOR-folded.
+ * @param  data: Buffer to check.
+ * @param  length: Number of bytes.
+ * @retval 8-bit check value.
+ */
+uint8_t crc8_hw(const uint8_t *data, uint8_t length)
+{
+    uint32_t word;
+    uint32_t crc;
+
+    LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_CRC);
+    LL_CRC_ResetCRCCalculationUnit(CRC);
+
+    for (uint8_t i = 0; i < length; i += 4)
+    {
+        word = 0;
+        for (uint8_t j = 0; j < 4; j++)
+        {
+            word <<= 8;
+            if (i + j < length)
+                word |= data[i + j];
+        }
+        LL_CRC_FeedData32(CRC, word);
+    }
+
+    crc = LL_CRC_ReadData32(CRC);
+    LL_AHB1_GRP1_DisableClock(LL_AHB1_GRP1_PERIPH_CRC);
+
+    crc ^= crc >> 16;
+    crc ^= crc >> 8;
+    return (uint8_t)crc;
+}
+#endif
+
+/**
+ * @brief  Computes the integrity byte of a packet with the configured check.
+ * @note   The legacy XOR check only covers data[], the CRC checks cover every
+ *          byte in front of dat_check.
+ * @param  p_packet: Packet to check.
+ * @retval Value for dat_check.
+ */
+uint8_t packet_check_calc(const Send_packet_t *p_packet)
+{
+#if (PACKET_CHECK_MODE == PACKET_CHECK_CRC8)
+    return crc8((const uint8_t *)p_packet, offsetof(Send_packet_t, dat_check));
+#elif (PACKET_CHECK_MODE == PACKET_CHECK_CRC_HW)
+    return crc8_hw((const uint8_t *)p_packet, offsetof(Send_packet_t, dat_check));
+#else
+    uint8_t dat_check;
+
+    PACKET_CHECK(dat_check, p_packet->data[0], p_packet->data[1], p_packet->data[2], p_packet->data[3]);
+    return dat_check;
+#endif
+}
+/**
+ * @brief  Fills packet_dat with key and temperature data.
+ * @param  type: Packet type, may carry PACKET_REPEAT_FLAG.
  * @param  key_1: First key press value.
  * @param  key_2: Second key press value.
- * @param  temp: Array of temperature data.
  * @retval None
  */
-void send_key_ntc_packet(uint8_t key_1, uint8_t key_2)
+static void key_ntc_packet_fill(uint8_t type, uint8_t key_1, uint8_t key_2)
 {
 #if (LED_FUNCTION_ENABLE)
     led_open();
 #endif
-    packet_dat.type = NTC_TYPE;
+    packet_dat.type = type;
     packet_dat.data[0] = key_1;
     packet_dat.data[1] = key_2;
     packet_dat.data[2] = dev_st.device_temp[0];
     packet_dat.data[3] = dev_st.device_temp[1];
-    send_data_check_set(packet_dat.data);
+    packet_dat.dat_check = packet_check_calc(&packet_dat);
+}
+
+/**
+ * @brief  Sends an auto-repeat frame for a held key.
+ * @details Sent RF_REPEAT_SEND_DATA_NUM times instead of a full burst, the
+ *          next repeat follows shortly. Marked with PACKET_REPEAT_FLAG when
+ *          PACKET_REPEAT_FLAG_ENABLE is set.
+ * @param  key_1: Key press value.
+ * @retval None
+ */
+void send_key_repeat_packet(uint8_t key_1)
+{
+#if (PACKET_REPEAT_FLAG_ENABLE)
+    key_ntc_packet_fill(NTC_TYPE | PACKET_REPEAT_FLAG, key_1, 0);
+#else
+    key_ntc_packet_fill(NTC_TYPE, key_1, 0);
+#endif
+#if (UI_RF_ENABLE)
+    re_send_start(RF_REPEAT_SEND_DATA_NUM);
+#endif
+}
+
+/**
+ * @brief  Sends a packet containing key press and temperature data.
+ * @param  key_1: First key press value.
+ * @param  key_2: Second key press value.
+ * @retval None
+ */
+void send_key_ntc_packet(uint8_t key_1, uint8_t key_2)
+{
+    key_ntc_packet_fill(NTC_TYPE, key_1, key_2);
 #if (UI_RF_ENABLE)
     re_send_enable(1);
 #endif
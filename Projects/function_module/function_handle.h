@@ -27,6 +27,15 @@ enum
     GYRO_TYPE,
 };
 
+// Set in Send_packet_t.type on auto-repeat frames of a held key
+#define PACKET_REPEAT_FLAG                      0x08
+
+// 1: mark auto-repeat frames with PACKET_REPEAT_FLAG, the receiver must know
+// the flag; 0: they go out as plain NTC_TYPE frames older receivers accept
+#ifndef PACKET_REPEAT_FLAG_ENABLE
+#define PACKET_REPEAT_FLAG_ENABLE               0
+#endif
+
 typedef struct Send_packet_t
 {
     uint8_t device_id[3];
@@ -38,6 +47,20 @@ typedef struct Send_packet_t
 extern Send_packet_t packet_dat;
 
 #define PACKET_CHECK(dat_check, dat_1, dat_2, dat_3, dat_4)            (dat_check = (dat_1 ^ dat_2 ^ dat_3 ^ dat_4) + 0x11)
+
+// Packet integrity check, the receiver must be built with the same mode
+#define PACKET_CHECK_XOR                        0   // legacy (data[0..3] XOR) + 0x11
+#define PACKET_CHECK_CRC8                       1   // CRC-8 poly 0x07 over the packet, table driven
+#define PACKET_CHECK_CRC_HW                     2   // CRC-32 hardware unit folded to 8 bits
+
+#ifndef PACKET_CHECK_MODE
+#define PACKET_CHECK_MODE                       PACKET_CHECK_XOR
+#endif
+
+// 1: 256-entry CRC-8 table (one lookup per byte), 0: 16-entry nibble table
+#ifndef PACKET_CRC8_FULL_TABLE
+#define PACKET_CRC8_FULL_TABLE                  0
+#endif
 /*============================================================================*
  *                          Functions
  *============================================================================*/
@@ -45,5 +68,9 @@ extern Send_packet_t packet_dat;
 /*============================================================================*
  *                      Extern Functions
  *============================================================================*/
+extern uint8_t crc8(const uint8_t *data, uint8_t length);
+extern uint8_t crc8_hw(const uint8_t *data, uint8_t length);
+extern uint8_t packet_check_calc(const Send_packet_t *p_packet);
 extern void send_key_ntc_packet(uint8_t key_1, uint8_t key_2);
+extern void send_key_repeat_packet(uint8_t key_1);
 #endif
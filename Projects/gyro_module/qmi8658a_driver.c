@@ -12,6 +12,7 @@
  *                              Header Files
  *============================================================================*/
 #include "qmi8658a_driver.h"
+#include "string.h"
 
 #if (GYROSCOPE_ENABLE)
 /*============================================================================*
@@ -19,6 +20,9 @@
  *============================================================================*/
 _Bool task_run = 0;
 uint8_t show_flag = 0;
+#if (QMI8658A_INT_ENABLE)
+volatile uint32_t qmi8658a_int_time = 0;    // clock_time() of the last INT2 edge
+#endif
 
 /*============================================================================*
  *                              Function Definitions
@@ -46,6 +50,107 @@ uint8_t qmi8658a_read_byte(uint8_t reg)
     return ret;
 }
 
+/**
+ * @brief Read one accelerometer and gyroscope sample in a single burst
+ *
+ * The register address auto-increments (CTRL1 ADDR_AI), so the whole output
+ * block is one I2C transaction instead of one per byte.
+ * @param p_sample Receives the raw sample
+ */
+void qmi8658a_read_sample(Qmi8658a_sample_t *p_sample)
+{
+    uint8_t data[QMI8658A_SAMPLE_LEN];
+    const uint8_t *p = &data[QMI8658A_AX_L - QMI8658A_SAMPLE_REG];
+
+    i2c_read_byte(QMI8658A_ADDRESS, QMI8658A_SAMPLE_REG, data, sizeof(data));
+
+    for (int i = 0; i < 3; i++)
+    {
+        p_sample->acc[i] = (int16_t)((p[2 * i + 1] << 8) | p[2 * i]);
+        p_sample->gyr[i] = (int16_t)((p[2 * i + 7] << 8) | p[2 * i + 6]);
+    }
+
+#if (QMI8658A_READ_TS_TEMP_ENABLE)
+    p_sample->timestamp = ((uint32_t)data[2] << 16) | ((uint32_t)data[1] << 8) | data[0];
+    p_sample->temp = (int16_t)((data[4] << 8) | data[3]);
+#endif
+}
+
+#if (QMI8658A_FIFO_ENABLE)
+/**
+ * @brief Run a CTRL9 host command and acknowledge it
+ * @param cmd QMI8658A_CTRL9_CMD_xxx
+ * @return true if the sensor reported the command done
+ */
+static _Bool qmi8658a_ctrl9_cmd(uint8_t cmd)
+{
+    uint8_t retry = 100;
+
+    i2c_write_byte(QMI8658A_ADDRESS, QMI8658A_CTRL9, &cmd, 1);
+    while (!(qmi8658a_read_byte(QMI8658A_STATUSINT) & QMI8658A_STATUSINT_CMD_DONE))
+    {
+        if (--retry == 0)
+            return 0;
+        WaitUs(20);
+    }
+
+    cmd = QMI8658A_CTRL9_CMD_ACK;
+    i2c_write_byte(QMI8658A_ADDRESS, QMI8658A_CTRL9, &cmd, 1);
+    return 1;
+}
+
+/**
+ * @brief Drain the sensor FIFO in one burst
+ *
+ * Reads the fill level, requests FIFO read mode through CTRL9, reads all
+ * complete frames from FIFO_DATA in one transaction and leaves read mode,
+ * which also empties the FIFO.
+ * @param p_samples Receives the raw samples, oldest first; also the read buffer
+ * @param max Capacity of p_samples
+ * @return Number of samples read
+ */
+uint8_t qmi8658a_fifo_read(Qmi8658a_sample_t *p_samples, uint8_t max)
+{
+    uint8_t *data = (uint8_t *)p_samples;
+    uint8_t level[2];
+    uint16_t bytes;
+    uint8_t num;
+
+    /* FIFO_SMPL_CNT and FIFO_STATUS[1:0] count 2-byte words */
+    i2c_read_byte(QMI8658A_ADDRESS, QMI8658A_FIFO_SMPL_CNT, level, sizeof(level));
+    bytes = (((uint16_t)(level[1] & 0x03) << 8) | level[0]) * 2;
+
+    num = bytes / QMI8658A_FIFO_FRAME_LEN;
+    if (num > max)
+        num = max;
+    if (num > QMI8658A_FIFO_DEPTH)
+        num = QMI8658A_FIFO_DEPTH;
+    if (num == 0 || !qmi8658a_ctrl9_cmd(QMI8658A_CTRL9_CMD_REQ_FIFO))
+        return 0;
+
+    /* Frames land packed at the start of p_samples and are decoded in place */
+    i2c_read_byte(QMI8658A_ADDRESS, QMI8658A_FIFO_DATA, data, num * QMI8658A_FIFO_FRAME_LEN);
+
+    level[0] = QMI8658A_FIFO_CTRL_SIZE_16 | QMI8658A_FIFO_CTRL_STREAM;
+    i2c_write_byte(QMI8658A_ADDRESS, QMI8658A_FIFO_CTRL, level, 1);
+
+    // 从后往前解码, 目标位置不会覆盖尚未解码的帧
+    for (uint8_t n = num; n-- > 0;)
+    {
+        uint8_t p[QMI8658A_FIFO_FRAME_LEN];
+
+        memcpy(p, &data[n * QMI8658A_FIFO_FRAME_LEN], sizeof(p));
+        for (int i = 0; i < 3; i++)
+        {
+            p_samples[n].acc[i] = (int16_t)((p[2 * i + 1] << 8) | p[2 * i]);
+            p_samples[n].gyr[i] = (int16_t)((p[2 * i + 7] << 8) | p[2 * i + 6]);
+        }
+    }
+
+    return num;
+}
+#endif
+
 /**
  * @brief Initialize QMI8658A sensor with proper configuration
  * @return true if initialization successful, false otherwise
@@ -66,8 +171,8 @@ _Bool qmi8658a_init(void)
     if (chip_id != QMI8658A_WHO_AM_I_VAL)
         return 0;
 
-    /* Configure SPI/I2C interface - use I2C, bit4=1 */
-    qmi8658a_write_byte(QMI8658A_CTRL1, 0x10);
+    /* Configure SPI/I2C interface - use I2C, bit4=1, auto increment for burst reads */
+    qmi8658a_write_byte(QMI8658A_CTRL1, 0x10 | QMI8658A_CTRL1_ADDR_AI);
 
     /* Configure accelerometer:
      * - Set full scale to ±8g (bits 6:4 = 010)
@@ -84,7 +189,7 @@ _Bool qmi8658a_init(void)
     /* Low pass filter setting - use default settings */
     qmi8658a_write_byte(QMI8658A_CTRL5, 0x00);
 
-    /* Enable sensors (Accelerometer and Gyroscope) */
+    /* Enable sensors (Accelerometer and Gyroscope), DRDY_DIS = 0 keeps data ready on INT2 */
     qmi8658a_write_byte(QMI8658A_CTRL7, 0x03);
 
     /* Motion detection control - disabled */
@@ -93,9 +198,15 @@ _Bool qmi8658a_init(void)
     /* Host commands - normal operation */
     qmi8658a_write_byte(QMI8658A_CTRL9, 0x00);
 
+#if (QMI8658A_FIFO_ENABLE)
+    /* Configure FIFO settings - stream mode, watermark interrupt on INT2 */
+    qmi8658a_write_byte(QMI8658A_FIFO_WTM_TH, QMI8658A_FIFO_WTM);
+    qmi8658a_write_byte(QMI8658A_FIFO_CTRL, QMI8658A_FIFO_CTRL_SIZE_16 | QMI8658A_FIFO_CTRL_STREAM);
+#else
     /* Configure FIFO settings - disabled */
     qmi8658a_write_byte(QMI8658A_FIFO_WTM_TH, 0x00);
     qmi8658a_write_byte(QMI8658A_FIFO_CTRL, 0x00);
+#endif
 
     return 1;
 }
@@ -138,6 +249,7 @@ void qmi8658a_driver_config(void)
     qmi8658a_driver_enable();
 }
 
+#if (!QMI8658A_INT_ENABLE)
 /**
  * @brief Configures the timing-related settings for the QMI8658A sensor.
  *
@@ -165,6 +277,54 @@ void qmi8658a_tim_config(void)
     NVIC_SetPriority(TIM14_IRQn, 1);
 }
 
+#endif
+
+#if (QMI8658A_INT_ENABLE)
+/**
+ * @brief Configures the INT2 interrupt input.
+ *
+ * INT2 rises when a new sample is ready, or with the FIFO enabled when the
+ * FIFO reaches QMI8658A_FIFO_WTM samples. The EXTI line is in interrupt and
+ * event mode, so it also ends a deep stop.
+ */
+void qmi8658a_int_config(void)
+{
+    LL_EXTI_InitTypeDef EXTI_InitStruct;
+
+    LL_IOP_GRP1_EnableClock(LL_IOP_GRP1_PERIPH_GPIOB);
+    LL_GPIO_SetPinMode(QMI8658A_INT_GPIO_PORT, QMI8658A_INT_PIN, LL_GPIO_MODE_INPUT);
+    LL_GPIO_SetPinPull(QMI8658A_INT_GPIO_PORT, QMI8658A_INT_PIN, LL_GPIO_PULL_DOWN);
+
+    LL_EXTI_SetEXTISource(QMI8658A_INT_EXTI_PORT, QMI8658A_INT_EXTI_LINE);
+
+    EXTI_InitStruct.Line = QMI8658A_INT_PIN;
+    EXTI_InitStruct.LineCommand = ENABLE;
+    EXTI_InitStruct.Mode = LL_EXTI_MODE_IT_EVENT;
+    EXTI_InitStruct.Trigger = LL_EXTI_TRIGGER_RISING;
+    LL_EXTI_Init(&EXTI_InitStruct);
+
+    NVIC_SetPriority(QMI8658A_INT_IRQN, 1);
+    NVIC_EnableIRQ(QMI8658A_INT_IRQN);
+}
+
+/**
+ * @brief Data ready / FIFO watermark interrupt handler.
+ *
+ * Timestamps the edge and marks the sample or batch ready; the data is read
+ * by the gyroscope task.
+ */
+void EXTI0_1_IRQHandler(void)
+{
+    if (LL_EXTI_ReadFlag(QMI8658A_INT_PIN))
+    {
+        LL_EXTI_ClearFlag(QMI8658A_INT_PIN);
+        qmi8658a_int_time = clock_time();
+        task_run = 1;
+        show_flag++;
+        task_set_ready(TASK_ID_GYROSCOPE);
+    }
+}
+#else
 /**
  * @brief TIM14 interrupt handler.
  *
@@ -179,8 +339,10 @@ void TIM14_IRQHandler(void)
         LL_TIM_ClearFlag_UPDATE(TIM14);
         task_run = 1;
         show_flag++;
+        task_set_ready(TASK_ID_GYROSCOPE);
     }
 }
+#endif
 
 /**
  * @brief Main loop function for the QMI8658A sensor operations.
@@ -191,7 +353,11 @@ void TIM14_IRQHandler(void)
  */
 void qmi8658a_setup_init(void)
 {
+#if (QMI8658A_INT_ENABLE)
+    qmi8658a_int_config();
+#else
     qmi8658a_tim_config();
+#endif
 
     qmi8658a_driver_config();
 
@@ -39,11 +39,93 @@
 #define QMI8658A_CTRL9                          0x0A
 #define QMI8658A_FIFO_WTM_TH                    0x13
 #define QMI8658A_FIFO_CTRL                      0x14
+#define QMI8658A_FIFO_SMPL_CNT                  0x15
+#define QMI8658A_FIFO_STATUS                    0x16
+#define QMI8658A_FIFO_DATA                      0x17
+#define QMI8658A_STATUSINT                      0x2D
+#define QMI8658A_TIMESTAMP_L                    0x30
+#define QMI8658A_TEMP_L                         0x33
+#define QMI8658A_AX_L                           0x35
+#define QMI8658A_GX_L                           0x3B
 #define QMI8658A_RESET                          0x60
 #define QMI8658A_WHO_AM_I_VAL                   0x05
 
+#define QMI8658A_CTRL1_ADDR_AI                  0x40    // register address auto increment
+#define QMI8658A_CTRL9_CMD_ACK                  0x00
+#define QMI8658A_CTRL9_CMD_REQ_FIFO             0x05
+#define QMI8658A_STATUSINT_CMD_DONE             0x80
+#define QMI8658A_FIFO_CTRL_RD_MODE              0x80
+#define QMI8658A_FIFO_CTRL_SIZE_16              0x00
+#define QMI8658A_FIFO_CTRL_STREAM               0x02
+
+// 1: batch samples in the sensor FIFO, drained on the watermark interrupt instead of TIM14 polling
+#ifndef QMI8658A_FIFO_ENABLE
+#define QMI8658A_FIFO_ENABLE                    0
+#endif
+
+// Samples per batch, at most the 16 sample FIFO
+#ifndef QMI8658A_FIFO_WTM
+#define QMI8658A_FIFO_WTM                       8
+#endif
+
+#define QMI8658A_FIFO_DEPTH                     16
+#define QMI8658A_FIFO_FRAME_LEN                 12      // accel + gyro, as in the output registers
+
+#if (QMI8658A_FIFO_WTM < 1 || QMI8658A_FIFO_WTM > QMI8658A_FIFO_DEPTH)
+#error "QMI8658A_FIFO_WTM must be 1..QMI8658A_FIFO_DEPTH"
+#endif
+
+// 1: sample on the data ready signal instead of TIM14, with a measured dt
+#ifndef QMI8658A_DRDY_ENABLE
+#define QMI8658A_DRDY_ENABLE                    0
+#endif
+
+#if (QMI8658A_FIFO_ENABLE && QMI8658A_DRDY_ENABLE)
+#error "QMI8658A_FIFO_ENABLE and QMI8658A_DRDY_ENABLE are exclusive"
+#endif
+
+// Sampling paced by INT2, TIM14 is not used
+#define QMI8658A_INT_ENABLE                     (QMI8658A_FIFO_ENABLE || QMI8658A_DRDY_ENABLE)
+
+// Longest sample interval (us) still taken as a dt, longer gaps keep the last dt
+#ifndef QMI8658A_DT_MAX_US
+#define QMI8658A_DT_MAX_US                      50000
+#endif
+
+// FIFO watermark or DRDY on INT2, routed to an EXTI line the keyboard does not use
+#define QMI8658A_INT_GPIO_PORT                  GPIOB
+#define QMI8658A_INT_PIN                        LL_GPIO_PIN_1
+#define QMI8658A_INT_EXTI_PORT                  LL_EXTI_CONFIG_PORTB
+#define QMI8658A_INT_EXTI_LINE                  LL_EXTI_CONFIG_LINE1
+#define QMI8658A_INT_IRQN                       EXTI0_1_IRQn
+
+// 1: the sample burst starts at the timestamp and also returns it and the temperature
+#ifndef QMI8658A_READ_TS_TEMP_ENABLE
+#define QMI8658A_READ_TS_TEMP_ENABLE            0
+#endif
+
+#if (QMI8658A_READ_TS_TEMP_ENABLE)
+#define QMI8658A_SAMPLE_REG                     QMI8658A_TIMESTAMP_L
+#else
+#define QMI8658A_SAMPLE_REG                     QMI8658A_AX_L
+#endif
+#define QMI8658A_SAMPLE_LEN                     (QMI8658A_GX_L + 6 - QMI8658A_SAMPLE_REG)
+
+typedef struct
+{
+    int16_t acc[3];             // raw accelerometer, X/Y/Z
+    int16_t gyr[3];             // raw gyroscope, X/Y/Z
+#if (QMI8658A_READ_TS_TEMP_ENABLE)
+    uint32_t timestamp;         // 24-bit sample counter
+    int16_t temp;               // 1/256 degC
+#endif
+} Qmi8658a_sample_t;
+
 extern _Bool task_run;
 extern uint8_t show_flag;
+#if (QMI8658A_INT_ENABLE)
+extern volatile uint32_t qmi8658a_int_time;
+#endif
 
 /*============================================================================*
  *                          Functions
@@ -55,6 +137,10 @@ extern uint8_t show_flag;
 extern void qmi8658a_setup_init(void);
 extern void qmi8658a_write_byte(uint8_t reg, uint8_t value);
 extern uint8_t qmi8658a_read_byte(uint8_t reg);
+extern void qmi8658a_read_sample(Qmi8658a_sample_t *p_sample);
+#if (QMI8658A_FIFO_ENABLE)
+extern uint8_t qmi8658a_fifo_read(Qmi8658a_sample_t *p_samples, uint8_t max);
+#endif
 
 #endif
 #endif
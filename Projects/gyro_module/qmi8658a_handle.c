@@ -34,48 +34,47 @@ float euler_angle[3] = {0, 0, 0};
 float quater[4] = {1, 0, 0, 0}; 
 float line_acc[3] = {0, 0, 0};
 
+#if (QMI8658A_FIXED_POINT_ENABLE)
+// One DF1 stage per axis: accel X/Y/Z, then gyro X/Y/Z
+static q31_t accel_coeffs[5];
+static q31_t gyro_coeffs[5];
+static q31_t biquad_state[6][4];
+static arm_biquad_casd_df1_inst_q31 biquad[6];
+
+// Raw LSB << Q_SHIFT to m/s² (±8g, 4096 LSB/g) and rad/s (±256dps, 128 LSB/dps, *10/573)
+static const float accel_q_scale = 9.80665f / (4096.0f * (1UL << QMI8658A_Q_SHIFT));
+static const float gyro_q_scale = 10.0f / (128.0f * 573.0f * (1UL << QMI8658A_Q_SHIFT));
+#endif
+
+#if (QMI8658A_INT_ENABLE)
+static uint32_t sample_time_last = 0;
+#endif
+
 /*============================================================================*
  *                              Function Definitions
  *============================================================================*/
 /**
- * @brief Read accelerometer data from QMI8658A and convert to m/s²
+ * @brief Convert raw accelerometer data to m/s²
+ * @param raw_accel Raw X,Y,Z acceleration
  * @param accel_float Array to store X,Y,Z acceleration in m/s²
  */
-void qmi8658a_read_accel_float(float accel_float[3])
+void qmi8658a_accel_to_float(const int16_t raw_accel[3], float accel_float[3])
 {
-    uint8_t data[6];
     const float accel_sensitivity = 4096.0f; // For ±8g range (from datasheet: 4096 LSB/g)
     const float gravity = 9.80665f;          // Standard gravity in m/s²
 
-    for (int i = 0; i < 6; i++)
-        data[i] = qmi8658a_read_byte(0x35 + i);
-
-    int16_t raw_accel[3];
-    raw_accel[0] = (int16_t)((data[1] << 8) | data[0]);
-    raw_accel[1] = (int16_t)((data[3] << 8) | data[2]);
-    raw_accel[2] = (int16_t)((data[5] << 8) | data[4]);
-
     for (int i = 0; i < 3; i++)
         accel_float[i] = ((float)raw_accel[i] / accel_sensitivity) * gravity;
 }
 
 /**
- * @brief Read gyroscope data from QMI8658A and convert to rad/s
+ * @brief Convert raw gyroscope data to rad/s
+ * @param raw_gyro Raw X,Y,Z angular rates
  * @param gyro_float Array to store X,Y,Z angular rates in rad/s
  */
-void qmi8658a_read_gyro_float(float gyro_float[3])
+void qmi8658a_gyro_to_float(const int16_t raw_gyro[3], float gyro_float[3])
 {
-    uint8_t data[6];
     const float gyro_sensitivity = 128.0f; // For ±256dps range (from datasheet: 128 LSB/dps)
-    const float dps_to_rads = 0.0174533f;  // Conversion factor from degrees/s to radians/s (pi/180)
-
-    for (int i = 0; i < 6; i++)
-        data[i] = qmi8658a_read_byte(0x3B + i);
-
-    int16_t raw_gyro[3];
-    raw_gyro[0] = (int16_t)((data[1] << 8) | data[0]);
-    raw_gyro[1] = (int16_t)((data[3] << 8) | data[2]);
-    raw_gyro[2] = (int16_t)((data[5] << 8) | data[4]);
 
     for (int i = 0; i < 3; i++)
         gyro_float[i] = ((float)raw_gyro[i] / gyro_sensitivity) * 10 / 573;
@@ -83,15 +82,133 @@ void qmi8658a_read_gyro_float(float gyro_float[3])
 
 /**
  * @brief Read both accelerometer and gyroscope data from QMI8658A as floating point
- * @param accel_float Array to store X,Y,Z acceleration in g
- * @param gyro_float Array to store X,Y,Z angular rates in dps
+ *
+ * One burst read of the output block per sample, see qmi8658a_read_sample().
+ * @param accel_float Array to store X,Y,Z acceleration in m/s²
+ * @param gyro_float Array to store X,Y,Z angular rates in rad/s
  */
 void qmi8658a_read_sensors_float(float accel_float[3], float gyro_float[3])
 {
-    qmi8658a_read_accel_float(accel_float);
-    qmi8658a_read_gyro_float(gyro_float);
+    Qmi8658a_sample_t sample;
+
+    qmi8658a_read_sample(&sample);
+
+    qmi8658a_accel_to_float(sample.acc, accel_float);
+    qmi8658a_gyro_to_float(sample.gyr, gyro_float);
+}
+
+#if (QMI8658A_FIXED_POINT_ENABLE)
+/**
+ * @brief Convert QST_Filter coefficients to the CMSIS-DSP DF1 q31 layout
+ *
+ * CMSIS adds the feedback terms, so a1 and a2 change sign.
+ * @param p_filter Float coefficients from set_cutoff_frequency()
+ * @param coeffs Receives {b0, b1, b2, -a1, -a2} in Q1.30
+ */
+static void qmi8658a_biquad_coeffs(const QST_Filter *p_filter, q31_t coeffs[5])
+{
+    const float one = (float)(1UL << (31 - QMI8658A_BIQUAD_POST_SHIFT));
+
+    coeffs[0] = (q31_t)(p_filter->b0 * one);
+    coeffs[1] = (q31_t)(p_filter->b1 * one);
+    coeffs[2] = (q31_t)(p_filter->b2 * one);
+    coeffs[3] = (q31_t)(-p_filter->a1 * one);
+    coeffs[4] = (q31_t)(-p_filter->a2 * one);
+}
+
+/**
+ * @brief Set up the six axis filters from the QST_Filter coefficients
+ */
+static void qmi8658a_biquad_init(void)
+{
+    qmi8658a_biquad_coeffs(&accel_filter, accel_coeffs);
+    qmi8658a_biquad_coeffs(&gyro_filter, gyro_coeffs);
+
+    for (int k = 0; k < 6; k++)
+        arm_biquad_cascade_df1_init_q31(&biquad[k], 1, k < 3 ? accel_coeffs : gyro_coeffs, biquad_state[k], QMI8658A_BIQUAD_POST_SHIFT);
+}
+
+/**
+ * @brief Filters a block of raw samples and feeds them to the fusion algorithm
+ *
+ * The samples are split into one Q31 buffer per axis and each axis is
+ * filtered in place by one arm_biquad_cascade_df1_q31() call per block,
+ * then each sample is scaled to physical units with one multiply per axis.
+ * @param p_samples Raw samples, oldest first
+ * @param num Number of samples
+ */
+static void qmi8658a_block_process(const Qmi8658a_sample_t *p_samples, uint8_t num)
+{
+    q31_t axis[6][QMI8658A_DSP_BLOCK];
+
+    while (num)
+    {
+        uint8_t n = (num < QMI8658A_DSP_BLOCK) ? num : QMI8658A_DSP_BLOCK;
+
+        for (uint8_t i = 0; i < n; i++)
+        {
+            // Multiply, a left shift of a negative sample is undefined
+            for (int k = 0; k < 3; k++)
+            {
+                axis[k][i] = (q31_t)p_samples[i].acc[k] * (1L << QMI8658A_Q_SHIFT);
+                axis[k + 3][i] = (q31_t)p_samples[i].gyr[k] * (1L << QMI8658A_Q_SHIFT);
+            }
+        }
+
+        for (int k = 0; k < 6; k++)
+            arm_biquad_cascade_df1_q31(&biquad[k], axis[k], axis[k], n);
+
+        for (uint8_t i = 0; i < n; i++)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                accel_correct[k] = accel_q_scale * (float)axis[k][i];
+                gyro_correct[k] = gyro_q_scale * (float)axis[k + 3][i];
+            }
+
+            // Update fusion algorithm
+            qst_fusion_update(accel_correct, gyro_correct, &dt, euler_angle, quater, line_acc);
+        }
+
+        p_samples += n;
+        num -= n;
+    }
+}
+#else
+/**
+ * @brief Filters one raw sample and feeds it to the fusion algorithm
+ * @param p_sample Raw accelerometer and gyroscope sample
+ */
+static void qmi8658a_sample_process(const Qmi8658a_sample_t *p_sample)
+{
+    qmi8658a_accel_to_float(p_sample->acc, accl);
+    qmi8658a_gyro_to_float(p_sample->gyr, gyro);
+
+    // Apply filter to raw sensor data
+    accel_correct[0] = Filter_Apply(accl[0], &accel_buf[0], &accel_filter);
+    accel_correct[1] = Filter_Apply(accl[1], &accel_buf[1], &accel_filter);
+    accel_correct[2] = Filter_Apply(accl[2], &accel_buf[2], &accel_filter);
+
+    gyro_correct[0] = Filter_Apply(gyro[0], &gyro_buf[0], &gyro_filter);
+    gyro_correct[1] = Filter_Apply(gyro[1], &gyro_buf[1], &gyro_filter);
+    gyro_correct[2] = Filter_Apply(gyro[2], &gyro_buf[2], &gyro_filter);
+
+    // Update fusion algorithm
+    qst_fusion_update(accel_correct, gyro_correct, &dt, euler_angle, quater, line_acc);
 }
 
+/**
+ * @brief Filters a block of raw samples and feeds them to the fusion algorithm
+ * @param p_samples Raw samples, oldest first
+ * @param num Number of samples
+ */
+static void qmi8658a_block_process(const Qmi8658a_sample_t *p_samples, uint8_t num)
+{
+    for (uint8_t i = 0; i < num; i++)
+        qmi8658a_sample_process(&p_samples[i]);
+}
+#endif
+
 /**
  * @brief Reads data from a specified register of the QMI8658 sensor.
  *
@@ -116,7 +233,31 @@ void qst_algo_init(void)
 {
     set_cutoff_frequency(50, 1, &gyro_filter); // First parameter is frequency 100Hz, related to algorithm library call period
     set_cutoff_frequency(50, 2, &accel_filter);
+
+#if (QMI8658A_FIXED_POINT_ENABLE)
+    qmi8658a_biquad_init();
+#endif
+}
+
+#if (QMI8658A_INT_ENABLE)
+/**
+ * @brief Updates the fusion dt from the INT2 timestamps
+ *
+ * The interval since the previous read is spread over the samples read now.
+ * The first read and gaps above QMI8658A_DT_MAX_US per sample keep the last dt.
+ * @param time clock_time() of the INT2 edge
+ * @param num Samples covered by the interval
+ */
+static void qmi8658a_dt_update(uint32_t time, uint8_t num)
+{
+    uint32_t elapsed = time - sample_time_last;
+
+    if (sample_time_last && num && elapsed && elapsed <= (uint32_t)QMI8658A_DT_MAX_US * num)
+        dt = (float)elapsed / (num * 1000000.0f);
+
+    sample_time_last = time;
 }
+#endif
 
 /**
  * @brief Processes data from the QMI8658A sensor.
@@ -126,19 +267,23 @@ void qst_algo_init(void)
  */
 void qmi8658a_data_process(void)
 {
-    qmi8658a_read_sensors_float(accl, gyro);
+#if (QMI8658A_FIFO_ENABLE)
+    Qmi8658a_sample_t batch[QMI8658A_FIFO_DEPTH];
+    uint8_t num = qmi8658a_fifo_read(batch, QMI8658A_FIFO_DEPTH);
 
-    // Apply filter to raw sensor data
-    accel_correct[0] = Filter_Apply(accl[0], &accel_buf[0], &accel_filter);
-    accel_correct[1] = Filter_Apply(accl[1], &accel_buf[1], &accel_filter);
-    accel_correct[2] = Filter_Apply(accl[2], &accel_buf[2], &accel_filter);
+    qmi8658a_dt_update(qmi8658a_int_time, num);
 
-    gyro_correct[0] = Filter_Apply(gyro[0], &gyro_buf[0], &gyro_filter);
-    gyro_correct[1] = Filter_Apply(gyro[1], &gyro_buf[1], &gyro_filter);
-    gyro_correct[2] = Filter_Apply(gyro[2], &gyro_buf[2], &gyro_filter);
+    // Oldest first, each sample one ODR period after the previous one
+    qmi8658a_block_process(batch, num);
+#else
+    Qmi8658a_sample_t sample;
 
-    // Update fusion algorithm
-    qst_fusion_update(accel_correct, gyro_correct, &dt, euler_angle, quater, line_acc);
+#if (QMI8658A_DRDY_ENABLE)
+    qmi8658a_dt_update(qmi8658a_int_time, 1);
+#endif
+    qmi8658a_read_sample(&sample);
+    qmi8658a_block_process(&sample, 1);
+#endif
 }
 
 void qmi8658a_loop(void)
@@ -26,6 +26,22 @@
 /*============================================================================*
  *                        Export Global Variables
  *============================================================================*/
+// 1: scale and low-pass filter samples in fixed point, floats only at the fusion input
+#ifndef QMI8658A_FIXED_POINT_ENABLE
+#define QMI8658A_FIXED_POINT_ENABLE             0
+#endif
+
+#if (QMI8658A_FIXED_POINT_ENABLE)
+#include "arm_math.h"
+
+#define QMI8658A_Q_SHIFT                        15      // raw LSB to Q31, one bit of headroom for overshoot
+#define QMI8658A_BIQUAD_POST_SHIFT              1       // coefficients in Q1.30, |a1| < 2
+
+// Samples filtered per CMSIS-DSP call, bounds the stack used for a FIFO batch
+#ifndef QMI8658A_DSP_BLOCK
+#define QMI8658A_DSP_BLOCK                      8
+#endif
+#endif
 
 /*============================================================================*
  *                          Functions
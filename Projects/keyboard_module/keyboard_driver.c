@@ -12,20 +12,38 @@
  *                              Header Files
  *============================================================================*/
 #include "keyboard_driver.h"
+#include "string.h"
 
 #if (UI_KEYBOARD_ENABLE)
 /*============================================================================*
  *                              Global Variables
  *============================================================================*/
-Kb_code kb_code;
-
-volatile uint32_t key_state = 0;
-volatile uint32_t key_timestamp = 0;
-volatile uint8_t current_row = 0;
+Kb_debounce_t kb_debounce;
+
+static Kb_event_t kb_event_fifo[KB_EVENT_FIFO_SIZE];
+static uint8_t kb_event_head = 0;       // free running, count is head - tail
+static uint8_t kb_event_tail = 0;
+static uint32_t kb_change_time = 0;     // last debounced change of any key
+static _Bool kb_hold_sent = 0;
+#if (KB_GHOST_DETECT_ENABLE)
+static _Bool kb_ghost_sent = 0;
+#endif
 
 const uint16_t row_pin[] = KB_ROW_PINS;
 const uint16_t col_pin[] = KB_COL_PINS;
 const uint16_t kb_map_num[ARRAY_SIZE(col_pin)][ARRAY_SIZE(row_pin)] = KB_MAP_NORMAL;
+
+#if (KB_TIMING_STAT_ENABLE)
+Kb_timing_t kb_timing[KB_TIMING_NUM];
+static _Bool kb_timing_dirty = 0;
+static uint32_t kb_scan_last = 0;       // start of the previous periodic scan, 0 after idle
+static uint32_t kb_raw_change_time = 0; // first sample that differed from the stable state
+#endif
+
+#if (KB_SCAN_ON_DEMAND_ENABLE)
+static uint32_t kb_col_exti_lines = 0;
+static uint32_t kb_idle_time = 0;
+#endif
 /*============================================================================*
  *                              Function Definitions
  *============================================================================*/
@@ -48,8 +66,16 @@ void kb_wakeup_exti_config(GPIO_TypeDef *group, uint8_t pin)
   /* Line command enable*/
   EXTI_InitStruct.LineCommand = ENABLE;
 
+#if (KB_SCAN_ON_DEMAND_ENABLE)
+  /* Event wakes deep stop, interrupt starts the scan burst */
+  EXTI_InitStruct.Mode = LL_EXTI_MODE_IT_EVENT;
+  kb_col_exti_lines |= pin;
+  NVIC_SetPriority(EXTI_PIN_TO_IRQN(pin), 1);
+  NVIC_EnableIRQ(EXTI_PIN_TO_IRQN(pin));
+#else
   /* Event mode */
   EXTI_InitStruct.Mode = LL_EXTI_MODE_EVENT;
+#endif
 
   /* Trigger Falling Mode */
   EXTI_InitStruct.Trigger = LL_EXTI_TRIGGER_FALLING;
@@ -69,15 +95,12 @@ void kb_wakeup_exti_config(GPIO_TypeDef *group, uint8_t pin)
  */
 void kb_gpio_event_handler(uint16_t group, uint8_t pin, Kb_gpio_event kb_gpio_event)
 {
-  for (uint8_t i = 0; i < 3; i++)
-  {
-    if (group == GPIO_GROUPA)
-      kb_gpio_event(GPIOA, pin);
-    else if (group == GPIO_GROUPB)
-      kb_gpio_event(GPIOB, pin);
-    else if (group == GPIO_GROUPC)
-      kb_gpio_event(GPIOC, pin);
-  }
+  if (group == GPIO_GROUPA)
+    kb_gpio_event(GPIOA, pin);
+  else if (group == GPIO_GROUPB)
+    kb_gpio_event(GPIOB, pin);
+  else if (group == GPIO_GROUPC)
+    kb_gpio_event(GPIOC, pin);
 }
 
 /**
@@ -106,28 +129,6 @@ void kb_gpio_init_col(GPIO_TypeDef *group, uint8_t pin_num)
   SET_PUPDR_UP(group, pin_num);
 }
 
-/**
- * @brief  Set a GPIO pin to high level.
- * @param  group Pointer to the GPIO port (e.g., GPIOA, GPIOB).
- * @param  pin_num Pin number to set high.
- * @retval None
- */
-void kb_gpio_set_high(GPIO_TypeDef *group, uint8_t pin_num)
-{
-  SET_ODR_HIGH(group, pin_num);
-}
-
-/**
- * @brief  Set a GPIO pin to low level.
- * @param  group Pointer to the GPIO port (e.g., GPIOA, GPIOB).
- * @param  pin_num Pin number to set low.
- * @retval None
- */
-void kb_gpio_set_low(GPIO_TypeDef *group, uint8_t pin_num)
-{
-  SET_ODR_LOW(group, pin_num);
-}
-
 /**
  * @brief  Initialize the keyboard matrix by configuring row and column pins.
  * @retval None
@@ -147,6 +148,16 @@ void keybroad_init(void)
   // 矩阵键盘唤醒初始化
   for (uint8_t i = 0; i < ARRAY_SIZE(col_pin); i++)
     kb_gpio_event_handler(GET_GPIO_GROUP(col_pin[i]), GET_GPIO_PIN(col_pin[i]), kb_wakeup_exti_config);
+
+  // 消抖计数器预置
+  for (uint8_t k = 0; k < ARRAY_SIZE(kb_debounce.cnt); k++)
+    kb_debounce.cnt[k] = (KB_DEBOUNCE_SAMPLES & (1 << k)) ? (Kb_bitboard_t)~0 : 0;
+
+#if (KB_SCAN_ON_DEMAND_ENABLE)
+  /* scanning runs until the first idle window has passed */
+  LL_EXTI_DisableIT(kb_col_exti_lines);
+  kb_idle_time = clock_time() | 1;
+#endif
 }
 
 /**
@@ -156,100 +167,410 @@ void keybroad_init(void)
 void kb_gpio_set_low_event(void)
 {
   for (uint8_t i = 0; i < ARRAY_SIZE(row_pin); i++)
-    kb_gpio_event_handler(GET_GPIO_GROUP(row_pin[i]), GET_GPIO_PIN(row_pin[i]), kb_gpio_set_low);
+    GET_GPIO_PORT(row_pin[i])->BRR = GET_GPIO_PIN(row_pin[i]);
+}
+
+/**
+ * @brief  Read the column lines.
+ * @details Each port is sampled with a single IDR read, so all columns are
+ *          taken at the same instant.
+ * @retval Bit i set when column i is pulled low.
+ */
+static uint8_t kb_col_read(void)
+{
+  uint32_t idr[3];
+  uint8_t col_state = 0;
+
+  idr[0] = ~GPIOA->IDR;
+  idr[1] = ~GPIOB->IDR;
+  idr[2] = ~GPIOC->IDR;
+
+  for (uint8_t i = 0; i < ARRAY_SIZE(col_pin); i++)
+  {
+    if (idr[GET_GPIO_PORT_INDEX(col_pin[i])] & GET_GPIO_PIN(col_pin[i]))
+      col_state |= (1 << i);
+  }
+  return col_state;
+}
+
+/**
+ * @brief  Busy wait for the column pull-ups after a row change.
+ * @retval None
+ */
+static void kb_row_settle(void)
+{
+  /* about four cycles per pass */
+  for (volatile uint16_t i = KB_ROW_SETTLE_US * CLOCK_SYS_TICKS_PER_US / 4; i; i--)
+    ;
+}
+
+/**
+ * @brief  Sweep the whole matrix in one pass.
+ * @details Rows are driven through BSRR/BRR, one at a time, and left high.
+ *          The pull-up settle delay is only paid after a row that had a
+ *          closed key, so an idle sweep takes a few microseconds.
+ * @retval Bit GET_KB_POS(row * cols, col) set for every closed key.
+ */
+static uint32_t kb_matrix_read(void)
+{
+  uint32_t matrix = 0;
+  uint8_t col_state = 0xFF;   // rows may have been held low while idle
+
+  // 拉高所有行线
+  for (uint8_t r = 0; r < ARRAY_SIZE(row_pin); r++)
+    GET_GPIO_PORT(row_pin[r])->BSRR = GET_GPIO_PIN(row_pin[r]);
+
+  for (uint8_t r = 0; r < ARRAY_SIZE(row_pin); r++)
+  {
+    GPIO_TypeDef *port = GET_GPIO_PORT(row_pin[r]);
+    uint8_t pin = GET_GPIO_PIN(row_pin[r]);
+
+    /* a column pulled low by the last row recovers through the weak pull-up */
+    if (col_state)
+      kb_row_settle();
+
+    // 激活当前行, 读取列线状态
+    port->BRR = pin;
+    __NOP();
+    __NOP();                  // input synchroniser
+    col_state = kb_col_read();
+    port->BSRR = pin;
+
+    matrix |= (uint32_t)col_state << (r * ARRAY_SIZE(col_pin));
+  }
+
+  return matrix;
 }
 
+#if (KB_GHOST_DETECT_ENABLE)
 /**
- * @brief  Scan the keyboard matrix to detect key presses and releases.
+ * @brief  Find the keys that may be phantoms of a diode-less matrix.
+ * @details Three closed corners of a rectangle also pull the fourth one low,
+ *          so any two rows sharing two or more closed columns are ambiguous.
+ *          Every corner of such a rectangle is returned; which of them is real
+ *          cannot be told from the sample.
+ * @param  raw Sampled matrix, bit set for a closed key.
+ * @retval Bits of every key on an ambiguous rectangle.
+ */
+static Kb_bitboard_t kb_ghost_mask(Kb_bitboard_t raw)
+{
+  const uint8_t cols = ARRAY_SIZE(col_pin);
+  const Kb_bitboard_t row_mask = (1U << cols) - 1;
+  Kb_bitboard_t mask = 0;
+
+  // 单键或单行不会产生幻影键
+  if ((raw & (raw - 1)) == 0)
+    return 0;
+
+  for (uint8_t r1 = 0; r1 < ARRAY_SIZE(row_pin) - 1; r1++)
+  {
+    Kb_bitboard_t row1 = (raw >> (r1 * cols)) & row_mask;
+
+    if ((row1 & (row1 - 1)) == 0)
+      continue;
+
+    for (uint8_t r2 = r1 + 1; r2 < ARRAY_SIZE(row_pin); r2++)
+    {
+      Kb_bitboard_t common = row1 & (raw >> (r2 * cols));
+
+      common &= row_mask;
+      if (common & (common - 1))
+        mask |= (common << (r1 * cols)) | (common << (r2 * cols));
+    }
+  }
+
+  return mask;
+}
+#endif
+
+/**
+ * @brief  Debounce every key at once with bit-sliced down counters.
+ * @details A key whose sample differs from its stable state counts down from
+ *          KB_DEBOUNCE_SAMPLES; a matching sample reloads the counter. The
+ *          state toggles when the counter hits zero, so each scan costs a
+ *          fixed handful of word operations whatever the number of keys.
+ * @param  raw Sampled matrix, bit set for a closed key.
+ * @retval Keys whose debounced state changed.
+ */
+static Kb_bitboard_t kb_debounce_update(Kb_bitboard_t raw)
+{
+  Kb_bitboard_t delta = raw ^ kb_debounce.stable;
+  Kb_bitboard_t borrow = delta;
+  Kb_bitboard_t toggle;
+  Kb_bitboard_t reload;
+
+  // 计数器减一
+  for (uint8_t k = 0; k < ARRAY_SIZE(kb_debounce.cnt); k++)
+  {
+    kb_debounce.cnt[k] ^= borrow;
+    borrow &= kb_debounce.cnt[k];
+  }
+
+  toggle = delta & ~(kb_debounce.cnt[0] | kb_debounce.cnt[1] | kb_debounce.cnt[2]);
+  reload = ~delta | toggle;
+
+  // 计数器重载
+  for (uint8_t k = 0; k < ARRAY_SIZE(kb_debounce.cnt); k++)
+  {
+    kb_debounce.cnt[k] &= ~reload;
+    if (KB_DEBOUNCE_SAMPLES & (1 << k))
+      kb_debounce.cnt[k] |= reload;
+  }
+
+  kb_debounce.raw = raw;
+  kb_debounce.stable ^= toggle;
+  kb_debounce.changed = toggle;
+
+  return toggle;
+}
+
+/**
+ * @brief  Queue a key event for the keyboard handler.
+ * @note   The FIFO holds one event per key and is drained after every scan,
+ *         which is the most a single scan can produce.
+ * @param  code Key code, 0 for KB_EVENT_HOLD.
+ * @param  type KB_EVENT_xxx.
+ * @param  time Scan timestamp.
+ * @retval None
+ */
+static void kb_event_put(uint8_t code, uint8_t type, uint32_t time)
+{
+  Kb_event_t *p_event;
+
+  if ((uint8_t)(kb_event_head - kb_event_tail) >= KB_EVENT_FIFO_SIZE)
+    return;
+
+  p_event = &kb_event_fifo[kb_event_head & (KB_EVENT_FIFO_SIZE - 1)];
+  p_event->code = code;
+  p_event->type = type;
+  p_event->time = time;
+  kb_event_head++;
+}
+
+/**
+ * @brief  Take the oldest key event.
+ * @param  p_event Receives the event.
+ * @retval 1 if an event was returned, 0 if the queue is empty.
+ */
+_Bool kb_event_get(Kb_event_t *p_event)
+{
+  if (kb_event_head == kb_event_tail)
+    return 0;
+
+  *p_event = kb_event_fifo[kb_event_tail & (KB_EVENT_FIFO_SIZE - 1)];
+  kb_event_tail++;
+  return 1;
+}
+
+#if (KB_TIMING_STAT_ENABLE)
+/**
+ * @brief  Add a sample to a timing histogram.
+ * @note   Log2 bins, so one histogram covers microseconds to tens of
+ *         milliseconds without a divide.
+ * @param  id KB_TIMING_xxx.
+ * @param  us Sample in microseconds.
+ * @retval None
+ */
+void kb_timing_add(uint8_t id, uint32_t us)
+{
+  Kb_timing_t *p_hist = &kb_timing[id];
+  uint8_t n = 0;
+
+  for (uint32_t v = us; v && n < KB_TIMING_BINS - 1; v >>= 1)
+    n++;
+
+  if (p_hist->bin[n] != 0xFFFF)
+    p_hist->bin[n]++;
+  if (us > p_hist->max_us)
+    p_hist->max_us = us;
+
+  kb_timing_dirty = 1;
+}
+
+/**
+ * @brief  Print the timing histograms over RTT and clear them.
+ * @note   Only does work when samples were added since the last dump.
+ * @retval None
+ */
+void kb_timing_dump(void)
+{
+  static const char *const name[KB_TIMING_NUM] = {"jitter", "scan", "debounce", "send"};
+
+  if (!kb_timing_dirty)
+    return;
+  kb_timing_dirty = 0;
+
+  for (uint8_t id = 0; id < KB_TIMING_NUM; id++)
+  {
+    rtt_printf("--->>> kb %s max:%u us |", name[id], kb_timing[id].max_us);
+    for (uint8_t n = 0; n < KB_TIMING_BINS; n++)
+      rtt_printf(" %u", kb_timing[id].bin[n]);
+    rtt_printf("\r\n");
+  }
+
+  memset(kb_timing, 0, sizeof(kb_timing));
+}
+
+/**
+ * @brief  Record scan cadence, scan cost and debounce latency.
+ * @param  start clock_time() at the start of the scan.
+ * @param  changed Keys toggled by this scan.
+ * @retval None
+ */
+static void kb_timing_scan(uint32_t start, Kb_bitboard_t changed)
+{
+  uint32_t end = clock_time() | 1;
+
+  if (kb_scan_last)
+  {
+    int32_t jitter = (int32_t)(start - kb_scan_last) - TASK_PERIOD_KEYBOARD * 1000;
+
+    kb_timing_add(KB_TIMING_JITTER, jitter < 0 ? -jitter : jitter);
+  }
+  kb_scan_last = start;
+
+  kb_timing_add(KB_TIMING_SCAN, end - start);
+
+  if (changed && kb_raw_change_time)
+  {
+    kb_timing_add(KB_TIMING_DEBOUNCE, start - kb_raw_change_time);
+    kb_raw_change_time = 0;
+  }
+  if (kb_debounce.raw ^ kb_debounce.stable)
+  {
+    if (!kb_raw_change_time)
+      kb_raw_change_time = start;
+  }
+  else
+  {
+    kb_raw_change_time = 0;
+  }
+}
+#endif
+
+/**
+ * @brief  Scan the keyboard matrix and queue press, release and hold events.
  * @retval Key status (KEY_DEBOUNCE, KEY_PRESSED, KEY_RELEASED)
  */
 uint8_t kb_matrix_scan(void)
 {
   uint8_t ret_status = KEY_DEBOUNCE;
+  uint32_t now = clock_time() | 1;
+  Kb_bitboard_t raw = kb_matrix_read();
+  Kb_bitboard_t changed;
 
-  // 拉高所有行线
-  for (uint8_t i = 0; i < ARRAY_SIZE(row_pin); i++)
-    kb_gpio_event_handler(GET_GPIO_GROUP(row_pin[i]), GET_GPIO_PIN(row_pin[i]), kb_gpio_set_high);
+#if (KB_GHOST_DETECT_ENABLE)
+  Kb_bitboard_t ghost = kb_ghost_mask(raw);
+
+  // 矩形内的键保持原状态, 已确认按下的键不受影响
+  if (ghost)
+  {
+    raw = (raw & ~ghost) | (kb_debounce.stable & ghost);
+    if (!kb_ghost_sent)
+      kb_event_put(0, KB_EVENT_GHOST, now);
+  }
+  kb_ghost_sent = (ghost != 0);
+#endif
 
-  // 激活当前行
-  kb_gpio_event_handler(GET_GPIO_GROUP(row_pin[current_row]), GET_GPIO_PIN(row_pin[current_row]), kb_gpio_set_low);
+  changed = kb_debounce_update(raw);
 
-  // 读取列线状态
-  uint8_t col_state = 0;
-  for (uint8_t i = 0; i < ARRAY_SIZE(col_pin); i++)
+#if (KB_TIMING_STAT_ENABLE)
+  kb_timing_scan(now, changed);
+#endif
+
+  if (changed == 0)
   {
-    uint16_t group_col = GET_GPIO_GROUP(col_pin[i]);
-    uint8_t pin_col = GET_GPIO_PIN(col_pin[i]);
-
-    // 根据组别读取对应端口的输入数据
-    if (group_col == GPIO_GROUPA)
-      col_state |= ((~GPIOA->IDR) & pin_col) ? (1 << i) : 0;
-    else if (group_col == GPIO_GROUPB)
-      col_state |= ((~GPIOB->IDR) & pin_col) ? (1 << i) : 0;
-    else if (group_col == GPIO_GROUPC)
-      col_state |= ((~GPIOC->IDR) & pin_col) ? (1 << i) : 0;
+    if (kb_debounce.stable && !kb_hold_sent && clock_time_exceed(kb_change_time, KB_HOLD_TIMEOUT * 1000))
+    {
+      kb_hold_sent = 1;
+      kb_event_put(0, KB_EVENT_HOLD, now);
+    }
+    return ret_status;
   }
 
-  for (uint8_t c = 0; c < ARRAY_SIZE(col_pin); c++)
+  kb_change_time = now;
+  kb_hold_sent = 0;
+
+  for (uint8_t pos = 0; changed; pos++, changed >>= 1)
   {
-    uint32_t pos = GET_KB_POS((current_row * ARRAY_SIZE(col_pin)), c);
-    uint32_t state = GET_KB_POS_STATUS(key_state, pos);
+    if ((changed & 1) == 0)
+      continue;
+
+    uint8_t code = kb_map_num[pos % ARRAY_SIZE(col_pin)][pos / ARRAY_SIZE(col_pin)];
 
-    if (col_state & (1 << c))
+    if (kb_debounce.stable & ((Kb_bitboard_t)1 << pos))
     {
-      if (state == KEY_RELEASED)
-      {
-        state = KEY_DEBOUNCE;
-        key_timestamp = clock_time() | 1;
-      }
-      else if (state == KEY_DEBOUNCE && clock_time_exceed(key_timestamp, KB_DITHER_TIMEOUT * 1000))
-      {
-        state = KEY_PRESSED;
-        ret_status = state;
-        kb_code.status = KB_SHORT_PRESS;
-        kb_code.kb_short_time = 0;
-        kb_code.kb_trigger_time = clock_time() | 1;
-
-        // 按键状态按下处理
-        if (kb_code.cnt < 0x02)
-        {
-          kb_code.kb_now_code[kb_code.cnt] = kb_map_num[c][current_row];
-          kb_code.cnt++;
-        }
-      }
+      ret_status = KEY_PRESSED;
+      kb_event_put(code, KB_EVENT_PRESS, now);
     }
     else
     {
-      if (state == KEY_PRESSED || state == KEY_DEBOUNCE)
-      {
-        state = KEY_RELEASED;
-        ret_status = state;
-        key_timestamp = clock_time() | 1;
-        kb_code.kb_trigger_time = 0;
-        kb_code.status = BK_RELEASE;
-
-        // 按键状态释放处理
-        if (kb_code.cnt)
-        {
-          kb_code.cnt--;
-          if (kb_code.kb_now_code[kb_code.cnt] != kb_map_num[c][current_row])
-          {
-            kb_code.kb_now_code[0] = kb_code.kb_now_code[kb_code.cnt];
-          }
-          kb_code.kb_now_code[kb_code.cnt] = 0;
-        }
-      }
+      ret_status = KEY_RELEASED;
+      kb_event_put(code, KB_EVENT_RELEASE, now);
     }
+  }
+
+  return ret_status;
+}
+
+#if (KB_SCAN_ON_DEMAND_ENABLE)
+/**
+ * @brief  Stop scanning once every key has been released for KB_SCAN_IDLE_TIMEOUT.
+ * @details All rows are driven low and the column EXTI interrupts are armed, so
+ *          the next key edge wakes the keyboard task through EXTI4_15_IRQHandler.
+ *          The keyboard task is parked before the interrupt is armed, so an edge
+ *          in between cannot be lost.
+ * @retval 1 if the matrix went idle, 0 if scanning must continue.
+ */
+_Bool kb_scan_try_idle(void)
+{
+  if (kb_debounce.stable | kb_debounce.raw)
+  {
+    kb_idle_time = clock_time() | 1;
+    return 0;
+  }
+
+  if (!clock_time_exceed(kb_idle_time, KB_SCAN_IDLE_TIMEOUT * 1000))
+    return 0;
+
+  task_set_period(TASK_ID_KEYBOARD, TASK_PERIOD_EVENT);
 
-    key_state &= CLEAR_KB_POS_STATUS(pos);
-    key_state |= SET_KB_POS_STATUS(pos, state);
+#if (KB_TIMING_STAT_ENABLE)
+  kb_scan_last = 0;
+#endif
+
+  kb_gpio_set_low_event();
+  LL_EXTI_ClearFlag(kb_col_exti_lines);
+  LL_EXTI_EnableIT(kb_col_exti_lines);
+
+  /* a key already held gives no edge, keep scanning */
+  if (kb_col_read())
+  {
+    LL_EXTI_DisableIT(kb_col_exti_lines);
+    task_set_period(TASK_ID_KEYBOARD, TASK_PERIOD_KEYBOARD);
+    return 0;
   }
 
-  // 切换下一行线
-  current_row = (current_row + 1) % ARRAY_SIZE(row_pin);
+  return 1;
+}
 
-  return ret_status;
+/**
+ * @brief  Column falling edge: resume periodic scanning.
+ * @retval None
+ */
+void EXTI4_15_IRQHandler(void)
+{
+  if (LL_EXTI_ReadFlag(kb_col_exti_lines))
+  {
+    LL_EXTI_DisableIT(kb_col_exti_lines);
+    LL_EXTI_ClearFlag(kb_col_exti_lines);
+
+    kb_idle_time = clock_time() | 1;
+    task_set_period(TASK_ID_KEYBOARD, TASK_PERIOD_KEYBOARD);
+    task_set_ready(TASK_ID_KEYBOARD);
+  }
 }
+#endif
 
 #if(KEYBOARD_TEST)
 /**
@@ -269,15 +590,13 @@ static void keyboard_test_loop(void)
     return;
   }
 
-  uint8_t det_key = kb_matrix_scan();
+  Kb_event_t evt;
 
-  if (det_key == KEY_PRESSED)
-  {
-    printf("--->>> kb_now_code[0] : %d ,kb_now_code[1] :%d \r\n", kb_code.kb_now_code[0], kb_code.kb_now_code[1]);
-  }
-  else if (det_key == KEY_RELEASED)
+  kb_matrix_scan();
+
+  while (kb_event_get(&evt))
   {
-    printf("--->>> kb_now_code[0] : %d ,kb_now_code[1] :%d \r\n", kb_code.kb_now_code[0], kb_code.kb_now_code[1]);
+    printf("--->>> key event type : %d ,code :%d ,time :%u \r\n", evt.type, evt.code, evt.time);
   }
 }
 #endif
@@ -31,23 +31,105 @@
 #define KB_SHORT_TIMEOUT                        150
 #endif
 
+// 1: idle with all rows low and column EXTI armed, scan only after a key edge
+#ifndef KB_SCAN_ON_DEMAND_ENABLE
+#define KB_SCAN_ON_DEMAND_ENABLE                1
+#endif
+
+// All keys released this long (ms) before scanning stops
+#ifndef KB_SCAN_IDLE_TIMEOUT
+#define KB_SCAN_IDLE_TIMEOUT                    100
+#endif
+
+// Column pull-up recovery after a row is released (us)
+#ifndef KB_ROW_SETTLE_US
+#define KB_ROW_SETTLE_US                        3
+#endif
+
+// Consecutive equal samples before a key changes state (vertical counter, 1..7)
+#define KB_DEBOUNCE_SAMPLES                     ((KB_DITHER_TIMEOUT + TASK_PERIOD_KEYBOARD - 1) / TASK_PERIOD_KEYBOARD)
+
+#if (KB_DEBOUNCE_SAMPLES < 1 || KB_DEBOUNCE_SAMPLES > 7)
+#error "KB_DITHER_TIMEOUT needs 1..7 keyboard scan periods"
+#endif
+
+// One bit per matrix position, GET_KB_POS(row * cols, col)
+#if (KB_TATOL > 16)
+typedef uint32_t Kb_bitboard_t;
+#else
+typedef uint16_t Kb_bitboard_t;
+#endif
+
+typedef struct
+{
+    Kb_bitboard_t raw;          // last sample
+    Kb_bitboard_t stable;       // debounced state
+    Kb_bitboard_t changed;      // stable bits toggled by the last scan
+    Kb_bitboard_t cnt[3];       // per-key down counters, bit-sliced
+} Kb_debounce_t;
+
+// Hold back keys forming a rectangle in the diode-less matrix, see KB_EVENT_GHOST
+#ifndef KB_GHOST_DETECT_ENABLE
+#define KB_GHOST_DETECT_ENABLE                  1
+#endif
+
+// Held keys unchanged this long (ms) before a KB_EVENT_HOLD
+#ifndef KB_HOLD_TIMEOUT
+#define KB_HOLD_TIMEOUT                         3000
+#endif
+
+// Key events buffered between scanner and handler, power of two, at least KB_TATOL
+#ifndef KB_EVENT_FIFO_SIZE
+#define KB_EVENT_FIFO_SIZE                      16
+#endif
+
+#if (KB_EVENT_FIFO_SIZE < KB_TATOL || (KB_EVENT_FIFO_SIZE & (KB_EVENT_FIFO_SIZE - 1)))
+#error "KB_EVENT_FIFO_SIZE must be a power of two holding one event per key"
+#endif
+
+enum
+{
+    KB_EVENT_PRESS,
+    KB_EVENT_RELEASE,
+    KB_EVENT_HOLD,              // code 0: applies to every key held
+    KB_EVENT_GHOST,             // code 0: ambiguous rectangle, its new keys are held back
+};
+
+typedef struct
+{
+    uint8_t code;               // kb_map_num entry
+    uint8_t type;               // KB_EVENT_xxx
+    uint32_t time;              // clock_time() of the scan that saw it
+} Kb_event_t;
+
+extern Kb_debounce_t kb_debounce;
+
+// 1: record scan and key latency histograms, dumped over RTT
+#ifndef KB_TIMING_STAT_ENABLE
+#define KB_TIMING_STAT_ENABLE                   0
+#endif
+
+#if (KB_TIMING_STAT_ENABLE)
+// Bin 0 holds 0 us, bin n holds [2^(n-1), 2^n) us, the last bin everything above
+#define KB_TIMING_BINS                          16
+
 enum
 {
-    BK_RELEASE,
-    KB_SHORT_PRESS,
-    KBLONG_PRESS_3S,
-    KB_TIMEOUT_5S
+    KB_TIMING_JITTER,           // |scan period - TASK_PERIOD_KEYBOARD|
+    KB_TIMING_SCAN,             // kb_matrix_scan() duration
+    KB_TIMING_DEBOUNCE,         // first changed sample to debounced event
+    KB_TIMING_SEND,             // press event to first key packet
+    KB_TIMING_NUM
 };
 
 typedef struct
 {
-    uint8_t cnt;
-    uint8_t kb_now_code[2];
-    uint8_t status;
-    uint32_t kb_short_time;
-    uint32_t kb_trigger_time;
-} Kb_code;
-extern Kb_code kb_code;
+    uint16_t bin[KB_TIMING_BINS];
+    uint32_t max_us;
+} Kb_timing_t;
+
+extern Kb_timing_t kb_timing[KB_TIMING_NUM];
+#endif
 
 typedef void (*Kb_gpio_event)           (GPIO_TypeDef *group, uint8_t pin_num);
 
@@ -102,12 +184,11 @@ typedef enum
 
 #define GET_GPIO_GROUP(port_pin)                ((port_pin) & 0xF00)
 #define GET_GPIO_PIN(port_pin)                  ((port_pin) & 0x00FF)
+// GPIO_GROUPx is the port offset from GPIOA_BASE
+#define GET_GPIO_PORT(port_pin)                 ((GPIO_TypeDef *)(GPIOA_BASE + GET_GPIO_GROUP(port_pin)))
+#define GET_GPIO_PORT_INDEX(port_pin)           (GET_GPIO_GROUP(port_pin) >> 10)
 
 #define GET_KB_POS(tatol_row, col)              ((tatol_row) + (col))
-#define GET_KB_POS_STATUS(list,pos)             ((list >> (pos * 2)) & 0x03)   
-
-#define CLEAR_KB_POS_STATUS(pos)                (~(0x03 << (pos * 2)))
-#define SET_KB_POS_STATUS(pos, st)              ((st << (pos * 2)))
 
 #define CLEAR_MODER(port, pin)                  (port->MODER &= ~(0x3 *((pin) * (pin))))
 #define SET_MODER_OUTPUT(port, pin)             (port->MODER |= (((pin) * (pin))))
@@ -126,6 +207,8 @@ typedef enum
                                                  (pin) == BIT(5) ? LL_EXTI_CONFIG_LINE5 : \
                                                  (pin) == BIT(6) ? LL_EXTI_CONFIG_LINE6 : \
                                                  (pin) == BIT(7) ? LL_EXTI_CONFIG_LINE7 : -1)
+#define EXTI_PIN_TO_IRQN(pin)                   ((pin) <= BIT(1) ? EXTI0_1_IRQn : \
+                                                 (pin) <= BIT(3) ? EXTI2_3_IRQn : EXTI4_15_IRQn)
 
 
 #define KEY_DEBOUNCE                            0x01 
@@ -139,8 +222,16 @@ typedef enum
  *                      Extern Functions
  *============================================================================*/
 extern uint8_t kb_matrix_scan(void);
+#if (KB_TIMING_STAT_ENABLE)
+extern void kb_timing_add(uint8_t id, uint32_t us);
+extern void kb_timing_dump(void);
+#endif
+extern _Bool kb_event_get(Kb_event_t *p_event);
 extern void kb_gpio_set_low_event(void);
 extern void keybroad_init(void);
+#if (KB_SCAN_ON_DEMAND_ENABLE)
+extern _Bool kb_scan_try_idle(void);
+#endif
 
 #endif
 #endif
\ No newline at end of file
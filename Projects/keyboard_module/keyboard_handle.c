@@ -14,6 +14,7 @@
 #include "keyboard_handle.h"
 #include "led_driver.h"
 #include "function_handle.h"
+#include "string.h"
 
 #if (UI_KEYBOARD_ENABLE)
 /*============================================================================*
@@ -21,95 +22,454 @@
  *============================================================================*/
 const uint8_t kb_list[KB_TATOL] = ROMORE_KEY_LIST;
 
+Kb_code kb_code;
+Kb_gesture_t kb_gesture;
+
+#if (KB_TIMING_STAT_ENABLE)
+static uint32_t kb_timing_press = 0;    // press event not yet followed by a packet
+#endif
+
+void key_press_timeout_event(void);
+static void key_chord_led_open(void);
+static void key_chord_led_close(void);
+static void key_action_as_short(void);
+static void key_action_hold(void);
+static void key_repeat_handler(void);
+
+static uint8_t kb_action_gesture;       // gesture being dispatched, selects the frame type
+static uint16_t kb_action_repeat;       // repeat ms of the row matched for kb_action_gesture
+
+/* Single key short presses send kb_list[code - 1] and are not listed here.
+ * A chord without a row for the gesture uses the KB_KEY_ANY row.
+ * A long press row runs once per hold, or every repeat ms while held.
+ * A key with a double tap row sends its short press as the tap, once the
+ * double tap window has closed; without a tap row that is kb_list[code - 1]. */
+static const Kb_action_t kb_action_table[KB_ACTION_ROWS] =
+{
+    {KB_KEY(KB_CODE_12),                KB_GESTURE_LONG,    RGB_HOLD,                   0,                          0},
+    {KB_KEY(KB_CODE_13),                KB_GESTURE_LONG,    COLOR_HOLD,                 0,                          0},
+
+    {KB_CHORD(KB_CODE_7, KB_CODE_9),    KB_GESTURE_SHORT,   0,                          key_chord_led_open,         0},
+    {KB_CHORD(KB_CODE_9, KB_CODE_13),   KB_GESTURE_SHORT,   0,                          key_chord_led_open,         0},
+    {KB_CHORD(KB_CODE_14, KB_CODE_16),  KB_GESTURE_SHORT,   0,                          key_chord_led_open,         0},
+    {KB_CHORD(KB_CODE_7, KB_CODE_9),    KB_GESTURE_LONG,    NOTE_TO_DEVICE_PAIR,        0,                          0},
+    {KB_CHORD(KB_CODE_9, KB_CODE_13),   KB_GESTURE_LONG,    NOTE_TO_DEVICE_PAIR_WIFI,   0,                          0},
+    {KB_CHORD(KB_CODE_14, KB_CODE_16),  KB_GESTURE_LONG,    NOTE_TO_WIFI_FACTORY_MODE,  0,                          0},
+
+    // fan key: tap switches, double tap reverses
+    {KB_KEY(KB_CODE_7),                 KB_GESTURE_DOUBLE,  REVERSIBLE,                 0,                          0},
+    // light key: tap switches, double tap steps the colour temperature
+    {KB_KEY(KB_CODE_9),                 KB_GESTURE_DOUBLE,  COLOR_TEMP,                 0,                          0},
+    // releasing a held RGB / colour key stops the hold burst still on air
+    {KB_KEY(KB_CODE_12),                KB_GESTURE_HOLD_RELEASE, 0,                     key_press_timeout_event,    0},
+    {KB_KEY(KB_CODE_13),                KB_GESTURE_HOLD_RELEASE, 0,                     key_press_timeout_event,    0},
+
+    {KB_KEY_ANY,                        KB_GESTURE_SHORT,   0,                          key_chord_led_close,        0},
+    {KB_KEY_ANY,                        KB_GESTURE_REPEAT,  0,                          key_action_as_short,        0},
+    // every scan pass, key_repeat_handler() paces the single key repeats itself
+    {KB_KEY_ANY,                        KB_GESTURE_LONG,    0,                          key_action_hold,            TASK_PERIOD_KEYBOARD},
+    {KB_KEY_ANY,                        KB_GESTURE_TIMEOUT, 0,                          key_press_timeout_event,    0},
+};
+
+// 0: empty, KB_ACTION_FROM_LIST | code: kb_list entry, else kb_action_table row + 1
+#define KB_ACTION_FROM_LIST         0x80
+static uint8_t kb_action_index[KB_ACTION_INDEX_SIZE];
+
+#if (KB_TATOL > 29)
+#error "key_action_hash() packs the chord above three gesture bits"
+#endif
+
+#if (KB_ACTION_INDEX_SIZE < 2 * (KB_ACTION_ROWS + KB_TATOL))
+#error "kb_action_index needs twice as many slots as kb_action_table rows plus kb_list entries"
+#endif
+
 /*============================================================================*
  *                              Function Definitions
  *============================================================================*/
 /**
- * @brief  Detects if a specific key combination has been pressed.
- * @param  key_1: The first key code or identifier.
- * @param  key_2: The second key code or identifier.
- * @retval Returns true if the specified key combination is detected, otherwise false.
+ * @brief  Lights the LED while a known chord is held.
+ * @retval None
  */
-_Bool key_combination_events(uint8_t key_1, uint8_t key_2)
+static void key_chord_led_open(void)
 {
-    if (((kb_code.kb_now_code[0] == key_1) && (kb_code.kb_now_code[1] == key_2)) ||
-        ((kb_code.kb_now_code[0] == key_2) && (kb_code.kb_now_code[1] == key_1)))
-        return 1;
-    return 0;
+#if (LED_FUNCTION_ENABLE)
+    led_open();
+#endif
 }
 
 /**
- * @brief  Handles a short press event for a single key.
- * @param  key: The key code or identifier of the pressed key.
- * @param  temp: Array containing temperature data.
+ * @brief  Turns the LED off for a chord without an action.
  * @retval None
  */
-void one_key_short_press_event()
+static void key_chord_led_close(void)
 {
-    for (uint8_t i = 1; i <= KB_TATOL; i++)
-        if (kb_code.kb_now_code[0] == i)
-            send_key_ntc_packet(kb_list[i - 1], 0);
+#if (LED_FUNCTION_ENABLE)
+    led_close();
+#endif
+}
+
+/**
+ * @brief  Hash slot of a chord and gesture in kb_action_index.
+ * @param  keys: Chord as KB_KEY() bits.
+ * @param  gesture: KB_GESTURE_xxx.
+ * @retval First slot to probe.
+ */
+static uint8_t key_action_hash(uint32_t keys, uint8_t gesture)
+{
+    uint32_t h = ((keys << 3) | gesture) * 2654435761U;
+
+    return (uint8_t)(h >> (32 - KB_ACTION_INDEX_BITS));
 }
 
 /**
- * @brief  Handles the event of a single key being pressed for a long duration.
- * @details This function is invoked when a key press is detected that exceeds
- *          a predefined duration threshold, indicating a long press event.
+ * @brief  Inserts one action into the dispatch index.
+ * @param  keys: Chord as KB_KEY() bits.
+ * @param  gesture: KB_GESTURE_xxx.
+ * @param  slot: Value stored in kb_action_index.
+ * @retval None
+ */
+static void key_action_index_add(uint32_t keys, uint8_t gesture, uint8_t slot)
+{
+    uint8_t h = key_action_hash(keys, gesture);
+
+    for (uint8_t n = 0; n < KB_ACTION_INDEX_SIZE; n++)
+    {
+        if (kb_action_index[h] == 0)
+        {
+            kb_action_index[h] = slot;
+            return;
+        }
+        h = (h + 1) & (KB_ACTION_INDEX_SIZE - 1);
+    }
+}
+
+/**
+ * @brief  Builds the dispatch index from kb_action_table and kb_list.
+ * @note   Table rows are inserted first, so they win over a kb_list entry
+ *         for the same key.
  * @param  None
  * @retval None
  */
-void one_key_long_press_event()
+void key_action_init(void)
+{
+    memset(kb_action_index, 0, sizeof(kb_action_index));
+
+    for (uint8_t i = 0; i < ARRAY_SIZE(kb_action_table); i++)
+        key_action_index_add(kb_action_table[i].keys, kb_action_table[i].gesture, i + 1);
+
+    for (uint8_t i = 1; i <= KB_TATOL; i++)
+        key_action_index_add(KB_KEY(i), KB_GESTURE_SHORT, KB_ACTION_FROM_LIST | i);
+}
+
+/**
+ * @brief  Sends a command, as a light repeat frame for KB_GESTURE_REPEAT.
+ * @param  command: Key command for the packet.
+ * @retval None
+ */
+static void key_action_send(uint8_t command)
 {
-    if (kb_code.kb_now_code[0] == KB_CODE_12)
-        send_key_ntc_packet(RGB_HOLD, 0);
-    else if (kb_code.kb_now_code[0] == KB_CODE_13)
-        send_key_ntc_packet(COLOR_HOLD, 0);
+#if (KB_TIMING_STAT_ENABLE)
+    if (kb_timing_press)
+    {
+        kb_timing_add(KB_TIMING_SEND, clock_time() - kb_timing_press);
+        kb_timing_press = 0;
+    }
+#endif
+
+    if (kb_action_gesture == KB_GESTURE_REPEAT)
+        send_key_repeat_packet(command);
+    else
+        send_key_ntc_packet(command, 0);
+}
+
+/**
+ * @brief  Finds the action for a chord and gesture.
+ * @param  keys: Chord as KB_KEY() bits.
+ * @param  gesture: KB_GESTURE_xxx.
+ * @retval kb_action_index slot value, 0 if there is no action.
+ */
+static uint8_t key_action_find(uint32_t keys, uint8_t gesture)
+{
+    uint8_t h = key_action_hash(keys, gesture);
+    uint8_t slot;
+
+    for (uint8_t n = 0; n < KB_ACTION_INDEX_SIZE && (slot = kb_action_index[h]) != 0; n++)
+    {
+        if (slot & KB_ACTION_FROM_LIST)
+        {
+            if (gesture == KB_GESTURE_SHORT && keys == KB_KEY(slot & ~KB_ACTION_FROM_LIST))
+                return slot;
+        }
+        else if (kb_action_table[slot - 1].keys == keys && kb_action_table[slot - 1].gesture == gesture)
+        {
+            return slot;
+        }
+        h = (h + 1) & (KB_ACTION_INDEX_SIZE - 1);
+    }
+    return 0;
+}
+
+/**
+ * @brief  Runs the action for a chord and gesture, if there is one.
+ * @param  keys: Chord as KB_KEY() bits.
+ * @param  gesture: KB_GESTURE_xxx.
+ * @retval 1 if an action matched.
+ */
+static _Bool key_action_run(uint32_t keys, uint8_t gesture)
+{
+    uint8_t slot = key_action_find(keys, gesture);
+
+    if (slot == 0)
+        return 0;
+
+#if (KB_ACTION_TRACE_ENABLE)
+    rtt_printf("--->>> kb keys:%lx gesture:%u slot:%02x\r\n", (unsigned long)keys, gesture, slot);
+#endif
+
+    if (slot & KB_ACTION_FROM_LIST)
+    {
+        key_action_send(kb_list[(slot & ~KB_ACTION_FROM_LIST) - 1]);
+    }
     else
     {
-        one_key_short_press_event();
+        const Kb_action_t *p_action = &kb_action_table[slot - 1];
+
+        // a long row running the short row keeps its own repeat
+        if (gesture == kb_action_gesture)
+            kb_action_repeat = p_action->repeat;
+        if (p_action->command)
+            key_action_send(p_action->command);
+        if (p_action->action)
+            p_action->action();
     }
+    return 1;
 }
 
 /**
- * @brief  Handles the event of two keys being pressed simultaneously in a short press.
- * @details This function is triggered when two keys are detected as pressed at the same time
- *          for a short duration. 
+ * @brief  Looks up a gesture of the held chord, falling back to the KB_KEY_ANY row.
+ * @param  gesture: KB_GESTURE_xxx.
+ * @retval None
+ */
+static void key_action_lookup(uint8_t gesture)
+{
+    if (!key_action_run(kb_code.kb_now_keys, gesture))
+        key_action_run(KB_KEY_ANY, gesture);
+}
+
+/**
+ * @brief  Dispatches a gesture of the held chord.
+ * @param  gesture: KB_GESTURE_xxx.
+ * @retval None
+ */
+static void key_action_dispatch(uint8_t gesture)
+{
+    kb_action_gesture = gesture;
+    kb_action_repeat = 0;
+    key_action_lookup(gesture);
+}
+
+/**
+ * @brief  Dispatches the long press of the held chord once per hold, then
+ *         again every repeat ms of the matched row if it has one.
  * @param  None
  * @retval None
  */
-void two_key_short_press_event()
+static void key_action_long(void)
 {
-    if (key_combination_events(KB_CODE_7, KB_CODE_9) ||
-        key_combination_events(KB_CODE_9, KB_CODE_13) ||
-        key_combination_events(KB_CODE_14, KB_CODE_16))
+    if (kb_code.kb_long_time == 0 ||
+        (kb_code.kb_long_repeat && clock_time_exceed(kb_code.kb_long_time, kb_code.kb_long_repeat * 1000)))
     {
-#if (LED_FUNCTION_ENABLE)
-        led_open();
-#endif
+        key_action_dispatch(KB_GESTURE_LONG);
+        kb_code.kb_long_time = clock_time() | 1;
+        kb_code.kb_long_repeat = kb_action_repeat;
     }
+}
+
+/**
+ * @brief  Runs the short press action of the held chord.
+ * @note   Keeps the dispatched gesture, so a repeat still sends a repeat frame.
+ * @retval None
+ */
+static void key_action_as_short(void)
+{
+    key_action_lookup(KB_GESTURE_SHORT);
+}
+
+/**
+ * @brief  Long press without its own row: a single key keeps auto-repeating,
+ *         a chord repeats its short action.
+ * @note   The repeat handler dispatches its own gestures, so the long press
+ *         gesture and row repeat are restored for key_action_long().
+ * @retval None
+ */
+static void key_action_hold(void)
+{
+    uint8_t gesture = kb_action_gesture;
+    uint16_t repeat = kb_action_repeat;
+
+    if (kb_code.cnt == ONE_KEY)
+        key_repeat_handler();
     else
+        key_action_as_short();
+
+    kb_action_gesture = gesture;
+    kb_action_repeat = repeat;
+}
+
+/**
+ * @brief  Dispatches a single key gesture from the gesture recognizer.
+ * @note   These gestures have no KB_KEY_ANY fallback. A tap without its own
+ *         row sends the short press it stands in for.
+ * @param  code: Key code.
+ * @param  gesture: KB_GESTURE_TAP, KB_GESTURE_DOUBLE or KB_GESTURE_HOLD_RELEASE.
+ * @retval None
+ */
+static void key_gesture_dispatch(uint8_t code, uint8_t gesture)
+{
+    kb_action_gesture = gesture;
+    if (!key_action_run(KB_KEY(code), gesture) && gesture == KB_GESTURE_TAP)
+        key_action_run(KB_KEY(code), KB_GESTURE_SHORT);
+}
+
+/**
+ * @brief  Holds back the short press of a key that may still become a tap.
+ * @details Only keys with a KB_GESTURE_DOUBLE row wait. The press waits until
+ *          it is held longer than KB_TAP_MAX, then acts as a normal press; the
+ *          second press of a double tap sends nothing else.
+ * @param  None
+ * @retval 1 while the held key must not send its short press.
+ */
+static _Bool key_gesture_defer(void)
+{
+    if (!kb_gesture.defer || kb_gesture.code != kb_code.kb_now_code[0])
+        return 0;
+    if (kb_gesture.taps == 2)
+        return 1;
+    if (!clock_time_exceed(kb_gesture.press_time, KB_TAP_MAX * 1000))
+        return 1;
+
+    kb_gesture.defer = 0;
+    return 0;
+}
+
+/**
+ * @brief  Classifies taps, double taps and hold-release of a single key.
+ * @details Runs on the key events, so it adds no scanning. A chord or a
+ *          different key ends the running sequence; a pending single tap is
+ *          reported first. Only a key with a double tap row opens the
+ *          double tap window, so other keys never keep the scanner awake.
+ * @param  p_event: Event taken from the scanner queue, after the held key
+ *                  list has been updated.
+ * @retval None
+ */
+static void key_gesture_event(Kb_event_t *p_event)
+{
+    switch (p_event->type)
     {
-#if (LED_FUNCTION_ENABLE)
-        led_close();
-#endif
+    case KB_EVENT_PRESS:
+        if (kb_code.cnt == ONE_KEY && kb_gesture.code == p_event->code && kb_gesture.taps == 1 &&
+            kb_gesture.release_time &&
+            (p_event->time - kb_gesture.release_time) <= KB_DOUBLE_TAP_WINDOW * 1000)
+        {
+            kb_gesture.taps = 2;
+            kb_gesture.release_time = 0;
+            kb_gesture.press_time = p_event->time;
+            key_gesture_dispatch(p_event->code, KB_GESTURE_DOUBLE);
+            break;
+        }
+
+        if (kb_gesture.code && kb_gesture.taps == 1 && kb_gesture.release_time)
+            key_gesture_dispatch(kb_gesture.code, KB_GESTURE_TAP);
+
+        kb_gesture.code = (kb_code.cnt == ONE_KEY) ? p_event->code : 0;
+        kb_gesture.taps = 1;
+        kb_gesture.press_time = p_event->time;
+        kb_gesture.release_time = 0;
+        kb_gesture.defer = kb_gesture.code && key_action_find(KB_KEY(p_event->code), KB_GESTURE_DOUBLE);
+        break;
+
+    case KB_EVENT_RELEASE:
+        if (kb_gesture.code != p_event->code)
+            break;
+
+        kb_gesture.hold_ms = (p_event->time - kb_gesture.press_time) / 1000;
+        if (kb_gesture.hold_ms >= KB_HOLD_TIMEOUT)
+        {
+            key_gesture_dispatch(p_event->code, KB_GESTURE_HOLD_RELEASE);
+            kb_gesture.code = 0;
+        }
+        else if (kb_gesture.defer && kb_gesture.taps == 1 && kb_gesture.hold_ms <= KB_TAP_MAX)
+        {
+            kb_gesture.release_time = p_event->time;
+        }
+        else
+        {
+            kb_gesture.code = 0;
+        }
+        break;
+
+    case KB_EVENT_GHOST:
+        // keys of an ambiguous chord may be phantoms, do not complete a tap on them
+        if (kb_gesture.code && kb_gesture.taps == 1 && kb_gesture.release_time)
+            key_gesture_dispatch(kb_gesture.code, KB_GESTURE_TAP);
+        kb_gesture.code = 0;
+        break;
+
+    default:
+        break;
     }
 }
 
 /**
- * @brief  Handles the event of two keys being pressed simultaneously for a long duration.
- * @details This function is invoked when two keys are detected as pressed at the same time
- *          and held for a period exceeding a predefined threshold, indicating a long press event.
+ * @brief  Reports a single tap once the double tap window has closed.
+ * @note   Only armed between a tap release and the end of its window.
+ * @param  None
+ * @retval 1 while a tap is still waiting for its window.
+ */
+static _Bool key_gesture_timer(void)
+{
+    if (kb_gesture.code == 0 || kb_gesture.release_time == 0)
+        return 0;
+
+    if (!clock_time_exceed(kb_gesture.release_time, KB_DOUBLE_TAP_WINDOW * 1000))
+        return 1;
+
+    key_gesture_dispatch(kb_gesture.code, KB_GESTURE_TAP);
+    kb_gesture.code = 0;
+    return 0;
+}
+
+/**
+ * @brief  Typematic repeat of a held single key.
+ * @details The first action fires on press, the first repeat after
+ *          KB_REPEAT_DELAY, then the interval shrinks by KB_REPEAT_ACCEL per
+ *          repeat from KB_REPEAT_INTERVAL down to KB_REPEAT_INTERVAL_MIN.
  * @param  None
  * @retval None
  */
-void two_key_long_press_event()
+static void key_repeat_handler(void)
 {
-    if (key_combination_events(KB_CODE_7, KB_CODE_9))
-        send_key_ntc_packet(NOTE_TO_DEVICE_PAIR, 0);
-    else if (key_combination_events(KB_CODE_9, KB_CODE_13))
-        send_key_ntc_packet(NOTE_TO_DEVICE_PAIR_WIFI, 0);
-    else if (key_combination_events(KB_CODE_14, KB_CODE_16))
-        send_key_ntc_packet(NOTE_TO_WIFI_FACTORY_MODE, 0);
+    if (key_gesture_defer())
+        return;
+
+    if (kb_code.kb_short_time == 0)
+    {
+        key_action_dispatch(KB_GESTURE_SHORT);
+        kb_code.kb_short_time = clock_time() | 1;
+        kb_code.kb_repeat_interval = KB_REPEAT_DELAY;
+    }
+    else if (clock_time_exceed(kb_code.kb_short_time, kb_code.kb_repeat_interval * 1000))
+    {
+        key_action_dispatch(KB_GESTURE_REPEAT);
+        kb_code.kb_short_time = clock_time() | 1;
+
+        if (kb_code.kb_repeat_interval > KB_REPEAT_INTERVAL)
+            kb_code.kb_repeat_interval = KB_REPEAT_INTERVAL;
+        else if (kb_code.kb_repeat_interval >= KB_REPEAT_INTERVAL_MIN + KB_REPEAT_ACCEL)
+            kb_code.kb_repeat_interval -= KB_REPEAT_ACCEL;
+        else
+            kb_code.kb_repeat_interval = KB_REPEAT_INTERVAL_MIN;
+    }
 }
 
 /**
@@ -148,6 +508,58 @@ void all_key_release_event(void)
     }
 }
 
+/**
+ * @brief  Applies one event from the key scanner to the held key list.
+ * @details Presses are appended and releases removed in place, so the list
+ *          keeps press order for any number of keys.
+ * @param  p_event: Event taken from the scanner queue.
+ * @retval None
+ */
+void key_event_handler(Kb_event_t *p_event)
+{
+    uint8_t i;
+
+    switch (p_event->type)
+    {
+    case KB_EVENT_PRESS:
+        kb_code.status = KB_SHORT_PRESS;
+        kb_code.kb_short_time = 0;
+        kb_code.kb_long_time = 0;
+        kb_code.kb_trigger_time = p_event->time;
+        if (kb_code.cnt < KB_TATOL)
+            kb_code.kb_now_code[kb_code.cnt++] = p_event->code;
+        kb_code.kb_now_keys |= KB_KEY(p_event->code);
+#if (KB_TIMING_STAT_ENABLE)
+        kb_timing_press = p_event->time;
+#endif
+        break;
+
+    case KB_EVENT_RELEASE:
+        kb_code.kb_trigger_time = 0;
+        kb_code.kb_long_time = 0;
+        kb_code.status = BK_RELEASE;
+        kb_code.kb_now_keys &= ~KB_KEY(p_event->code);
+        for (i = 0; i < kb_code.cnt; i++)
+            if (kb_code.kb_now_code[i] == p_event->code)
+                break;
+        if (i < kb_code.cnt)
+        {
+            kb_code.cnt--;
+            memmove(&kb_code.kb_now_code[i], &kb_code.kb_now_code[i + 1], kb_code.cnt - i);
+            kb_code.kb_now_code[kb_code.cnt] = 0;
+        }
+        break;
+
+    case KB_EVENT_HOLD:
+        if (kb_code.status == KB_SHORT_PRESS)
+            kb_code.status = KBLONG_PRESS_3S;
+        break;
+
+    default:
+        break;
+    }
+}
+
 /**
  * @brief  Updates the status of the key press events.
  * @details This function evaluates the current state of key presses and sets the 
@@ -164,11 +576,7 @@ void key_status_set_event(void)
             kb_code.kb_trigger_time = clock_time() | 1;
             kb_code.status = KB_SHORT_PRESS;
         }
-        if (kb_code.status == KB_SHORT_PRESS && kb_code.kb_trigger_time && clock_time_exceed(kb_code.kb_trigger_time, 3 * 1000 * 1000))
-        {
-            kb_code.status = KBLONG_PRESS_3S;
-        }
-        else if (kb_code.status == KBLONG_PRESS_3S && kb_code.kb_trigger_time && clock_time_exceed(kb_code.kb_trigger_time, 45 * 100 * 1000))
+        if (kb_code.status == KBLONG_PRESS_3S && kb_code.kb_trigger_time && clock_time_exceed(kb_code.kb_trigger_time, 45 * 100 * 1000))
         {
             kb_code.status = KB_TIMEOUT_5S;
         }
@@ -176,49 +584,60 @@ void key_status_set_event(void)
 }
 /**
  * @brief  Scan the keyboard matrix to detect key presses and releases.
- * @retval Key status (KEY_DEBOUNCE, KEY_PRESSED, KEY_RELEASED)
+ * @note   Runs every TASK_PERIOD_KEYBOARD ms from the task scheduler while
+ *         a key is down; with KB_SCAN_ON_DEMAND_ENABLE it is parked in between
+ *         and restarted by the column EXTI.
+ * @retval None
  */
 void keyboard_loop(void)
 {
-    static uint32_t tick;
-
-    if (clock_time_exceed(tick, 8000))
-        tick = clock_time() | 1;
-    else
-        return;
+    Kb_event_t evt;
 
     kb_matrix_scan();
 
+    while (kb_event_get(&evt))
+    {
+        key_event_handler(&evt);
+        key_gesture_event(&evt);
+    }
+
+#if (KB_SCAN_ON_DEMAND_ENABLE)
+    if (!key_gesture_timer() && kb_scan_try_idle())
+        return;
+#else
+    key_gesture_timer();
+#endif
+
     key_status_set_event();
 
     if (kb_code.status == KB_SHORT_PRESS)
     {
-        if (kb_code.cnt == ONE_KEY && clock_time_exceed(kb_code.kb_short_time, KB_SHORT_TIMEOUT * 1000))
+        if (kb_code.cnt == ONE_KEY)
         {
-            kb_code.kb_short_time = clock_time() | 1;
-            one_key_short_press_event();
+            key_repeat_handler();
         }
-        if (kb_code.cnt == TWO_KEY)
+        if (kb_code.cnt >= TWO_KEY)
         {
-            two_key_short_press_event();
+            key_action_dispatch(KB_GESTURE_SHORT);
         }
     }
     else if (kb_code.status == KBLONG_PRESS_3S)
     {
-        if (kb_code.cnt == ONE_KEY)
-        {
-            one_key_long_press_event();
-        }
-        if (kb_code.cnt == TWO_KEY)
+        if (kb_code.cnt)
         {
-            two_key_long_press_event();
+            key_action_long();
         }
     }
     else if (kb_code.status == KB_TIMEOUT_5S)
     {
-        key_press_timeout_event();
+        key_action_dispatch(KB_GESTURE_TIMEOUT);
     }
 
     all_key_release_event();
+
+#if (KB_TIMING_STAT_ENABLE)
+    if (kb_code.cnt == NULL_KEY)
+        kb_timing_dump();
+#endif
 }
 #endif
\ No newline at end of file
@@ -17,6 +17,7 @@
  *============================================================================*/
 #include "main.h"
 #include "app.h"
+#include "keyboard_config.h"
 #include "keyboard_driver.h"
 /*============================================================================*
  *                        Export Global Variables
@@ -52,6 +53,101 @@
                                     LED_SWITCH, GEAR_ADD,    REVERSIBLE,  RGB_SWITCH,\
                                     COLOR_TEMP, TIME_1_HOUR, TIME_4_HOUR, TIME_8_HOUR}
 
+enum
+{
+    BK_RELEASE,
+    KB_SHORT_PRESS,
+    KBLONG_PRESS_3S,
+    KB_TIMEOUT_5S
+};
+
+typedef struct
+{
+    uint8_t cnt;                        // keys held
+    uint8_t kb_now_code[KB_TATOL];      // held key codes, oldest press first
+    uint32_t kb_now_keys;               // held key codes as KB_KEY() bits
+    uint8_t status;
+    uint32_t kb_short_time;             // last short/repeat action, 0 before the first
+    uint16_t kb_repeat_interval;        // ms until the next repeat
+    uint32_t kb_trigger_time;           // scan time of the last key change
+    uint32_t kb_long_time;              // last long press action, 0 before the first of this hold
+    uint16_t kb_long_repeat;            // ms until the long press action runs again, 0 for never
+} Kb_code;
+extern Kb_code kb_code;
+
+/* Typematic repeat of a held single key (ms) */
+#ifndef KB_REPEAT_DELAY
+#define KB_REPEAT_DELAY             400                 // press to first repeat
+#endif
+#ifndef KB_REPEAT_INTERVAL
+#define KB_REPEAT_INTERVAL          KB_SHORT_TIMEOUT    // first repeat interval
+#endif
+#ifndef KB_REPEAT_INTERVAL_MIN
+#define KB_REPEAT_INTERVAL_MIN      100                 // not below one RF frame on air
+#endif
+#ifndef KB_REPEAT_ACCEL
+#define KB_REPEAT_ACCEL             20                  // interval decrease per repeat
+#endif
+
+// 1: trace every matched action over RTT
+#ifndef KB_ACTION_TRACE_ENABLE
+#define KB_ACTION_TRACE_ENABLE      0
+#endif
+
+/* Single key gestures (ms) */
+#ifndef KB_TAP_MAX
+#define KB_TAP_MAX                  300                 // press to release of a tap
+#endif
+#ifndef KB_DOUBLE_TAP_WINDOW
+#define KB_DOUBLE_TAP_WINDOW        300                 // release to second press
+#endif
+
+typedef struct
+{
+    uint8_t code;                       // key of the running sequence, 0 for none
+    uint8_t taps;                       // presses in the sequence
+    uint32_t press_time;                // event time of the last press
+    uint32_t release_time;              // event time of the last tap release, 0 while held
+    uint32_t hold_ms;                   // press duration for KB_GESTURE_HOLD_RELEASE
+    _Bool defer;                        // key has a double tap row, its short press waits
+} Kb_gesture_t;
+extern Kb_gesture_t kb_gesture;
+
+/* Key action table */
+enum
+{
+    KB_GESTURE_SHORT,                   // chord pressed
+    KB_GESTURE_REPEAT,                  // single key still held, typematic rate
+    KB_GESTURE_LONG,                    // chord held KB_HOLD_TIMEOUT
+    KB_GESTURE_TIMEOUT,                 // chord held past the long press window
+    KB_GESTURE_TAP,                     // single key tapped once, after KB_DOUBLE_TAP_WINDOW
+    KB_GESTURE_DOUBLE,                  // single key pressed again within KB_DOUBLE_TAP_WINDOW
+    KB_GESTURE_HOLD_RELEASE,            // single key released after a long press, see hold_ms
+    KB_GESTURE_NUM
+};
+
+#define KB_KEY(code)                (1UL << ((code) - 1))
+#define KB_CHORD(code_1, code_2)    (KB_KEY(code_1) | KB_KEY(code_2))
+#define KB_KEY_ANY                  0   // row used when no chord row matches
+
+typedef void (*Kb_action_func)(void);
+
+typedef struct
+{
+    uint32_t keys;                      // KB_KEY()/KB_CHORD(), or KB_KEY_ANY
+    uint8_t gesture;                    // KB_GESTURE_xxx
+    uint8_t command;                    // sent with send_key_ntc_packet(), 0 for none
+    Kb_action_func action;              // called after the command, may be 0
+    uint16_t repeat;                    // KB_GESTURE_LONG: ms between runs while held, 0 for once per hold
+} Kb_action_t;
+
+// Rows of kb_action_table, sizes kb_action_index below
+#define KB_ACTION_ROWS              16
+
+// Dispatch hash slots, power of two, at least twice the actions incl. kb_list
+#define KB_ACTION_INDEX_BITS        6
+#define KB_ACTION_INDEX_SIZE        (1 << KB_ACTION_INDEX_BITS)
+
 enum
 {
     KB_CODE_0,
@@ -80,5 +176,6 @@ enum
 /*============================================================================*
  *                      Extern Functions
  *============================================================================*/
+extern void key_action_init(void);
 extern void keyboard_loop(void);
 #endif
@@ -57,6 +57,7 @@ extern "C" {
 #include "qmi8658a_driver.h"
 #include "qmi8658a_handle.h"
 #include "433_send_driver.h"
+#include "task_handle.h"
 
 
 #if defined(USE_FULL_ASSERT)
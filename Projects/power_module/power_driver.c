@@ -20,6 +20,11 @@
 _Bool power_on = 0;
 volatile uint32_t tick = 0;
 
+#if (UI_KEYBOARD_ENABLE && KB_HOLD_STOP_ENABLE)
+static uint32_t lptim_residue = 0;      // STOP time not yet credited, 1/LPTIM_CLOCK_HZ ms units
+static volatile _Bool lptim_wake = 0;   // LPTIM1_IRQHandler saw the period end
+#endif
+
 /*============================================================================*
  *                              Function Definitions
  *============================================================================*/
@@ -60,8 +65,124 @@ _Bool enter_deepstop_condition()
     return 1;
 }
 
+/**
+ * @brief  Enters STOP mode until the next wake-up event or interrupt.
+ * @param  None
+ * @retval None
+ */
+static void app_stop_enter(void)
+{
+    /* Enable PWR clock */
+    LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_PWR);
+
+    /* STOP mode with deep low power regulator ON */
+    LL_PWR_SetLprMode(LL_PWR_LPR_MODE_DLPR);
+
+    /* SRAM retention voltage aligned with digital LDO output */
+    LL_PWR_SetStopModeSramVoltCtrl(LL_PWR_SRAM_RETENTION_VOLT_CTRL_LOW);
+
+    /* Enter DeepSleep mode */
+    LL_LPM_EnableDeepSleep();
+
+    /* Request Wait For Event */
+    __SEV();
+    __WFE();
+    __WFE();
+
+    LL_LPM_EnableSleep();
+}
+
+#if (UI_KEYBOARD_ENABLE && KB_HOLD_STOP_ENABLE)
+/**
+ * @brief  Prepares LPTIM as the STOP mode scan clock.
+ * @details LPTIM counts LSI / 32 and wakes the core through EXTI line 29.
+ *          The counter only runs while a held key keeps the core in STOP.
+ * @param  None
+ * @retval None
+ */
+static void lptim_scan_init(void)
+{
+    static _Bool ready = 0;
+
+    if (ready)
+        return;
+    ready = 1;
+
+    LL_RCC_LSI_Enable();
+    while (!LL_RCC_LSI_IsReady())
+        ;
+
+    LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_LPTIM1);
+    LL_RCC_SetLPTIMClockSource(LL_RCC_LPTIM1_CLKSOURCE_LSI);
+    LL_LPTIM_SetPrescaler(LPTIM1, LL_LPTIM_PRESCALER_DIV32);
+    LL_LPTIM_SetUpdateMode(LPTIM1, LL_LPTIM_UPDATE_MODE_IMMEDIATE);
+    LL_LPTIM_EnableIT_ARRM(LPTIM1);
+
+    LL_EXTI_EnableIT(LL_EXTI_LINE_29);
+    NVIC_SetPriority(LPTIM1_IRQn, 2);
+    NVIC_EnableIRQ(LPTIM1_IRQn);
+}
+
+/**
+ * @brief  Sleeps in STOP for one held key scan period.
+ * @details SysTick stops with the core clock, so the LPTIM count is credited
+ *          back to the timebase on wake-up. The rows stay high, so key changes
+ *          are only seen by the next scan; another interrupt, such as the
+ *          QMI8658A INT2 EXTI, ends the sleep early and only the elapsed part
+ *          is credited.
+ * @param  None
+ * @retval None
+ */
+static void app_hold_stop(void)
+{
+    uint32_t ticks;
+
+    lptim_scan_init();
+
+    lptim_wake = 0;
+    LL_LPTIM_Enable(LPTIM1);
+    LL_LPTIM_SetAutoReload(LPTIM1, (KB_HOLD_STOP_PERIOD * LPTIM_CLOCK_HZ) / 1000);
+    LL_LPTIM_StartCounter(LPTIM1, LL_LPTIM_OPERATING_MODE_ONESHOT);
+
+    app_stop_enter();
+
+    // 计数器异步于APB, 连续两次读数一致才有效
+    do
+    {
+        ticks = LL_LPTIM_GetCounter(LPTIM1);
+    } while (ticks != LL_LPTIM_GetCounter(LPTIM1));
+
+    // one-shot mode clears the counter at the match, the whole period only
+    // counts once ARRM was seen; any other wake-up credits the elapsed count
+    if (lptim_wake || LL_LPTIM_IsActiveFlag_ARRM(LPTIM1))
+        ticks = LL_LPTIM_GetAutoReload(LPTIM1);
+
+    LL_LPTIM_Disable(LPTIM1);
+    LL_LPTIM_ClearFLAG_ARRM(LPTIM1);
+
+    lptim_residue += ticks * 1000;
+    systick_advance_ms(lptim_residue / LPTIM_CLOCK_HZ);
+    lptim_residue %= LPTIM_CLOCK_HZ;
+}
+
+/**
+ * @brief  LPTIM1 interrupt handler, leaves STOP mode and marks the full period.
+ * @retval None
+ */
+void LPTIM1_IRQHandler(void)
+{
+    if (LL_LPTIM_IsActiveFlag_ARRM(LPTIM1))
+    {
+        LL_LPTIM_ClearFLAG_ARRM(LPTIM1);
+        lptim_wake = 1;
+    }
+}
+#endif
+
 /**
  * @brief  Enter deep stop mode
+ * @details While keys are held the core still uses STOP between scans, with
+ *          LPTIM as the wake-up, as long as no RF frame is on the air.
  * @param  None
  * @retval None
  */
@@ -71,6 +192,10 @@ void app_enter_deepstop(void)
     if (kb_code.cnt)
     {
         tick = clock_time() | 1;
+#if (KB_HOLD_STOP_ENABLE)
+        if (rf_send_st.send_status == SEND_IDLE && !rf_send_is_working())
+            app_hold_stop();
+#endif
         return;
     }
     else 
@@ -91,23 +216,6 @@ void app_enter_deepstop(void)
 
     enter_sleep_clear_event();
 
-    /* Enable PWR clock */
-    LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_PWR);
-
-    /* STOP mode with deep low power regulator ON */
-    LL_PWR_SetLprMode(LL_PWR_LPR_MODE_DLPR);
-
-    /* SRAM retention voltage aligned with digital LDO output */
-    LL_PWR_SetStopModeSramVoltCtrl(LL_PWR_SRAM_RETENTION_VOLT_CTRL_LOW);
-
-    /* Enter DeepSleep mode */
-    LL_LPM_EnableDeepSleep();
-
-    /* Request Wait For Event */
-    __SEV();
-    __WFE();
-    __WFE();
-
-    LL_LPM_EnableSleep();
+    app_stop_enter();
 }
 #endif
\ No newline at end of file
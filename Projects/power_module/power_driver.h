@@ -17,6 +17,7 @@
  *============================================================================*/
 #include "main.h"
 #include "app.h"
+#include "py32f002b_ll_lptim.h"
 
 #if(LOW_POWER_ENABLE)
 /*============================================================================*
@@ -25,6 +26,21 @@
 #ifndef RCU_ENTER_SLEEP_TIMEOUT
 #define RCU_ENTER_SLEEP_TIMEOUT                       100
 #endif
+
+// While keys are held, sleep in STOP between scans and wake on LPTIM.
+// TIM14 stops in STOP, so it stays off while TIM14 paces the IMU samples:
+// it needs LOW_POWER_ENABLE, and GYROSCOPE_ENABLE 0 or a QMI8658A INT mode.
+#ifndef KB_HOLD_STOP_ENABLE
+#define KB_HOLD_STOP_ENABLE                           (!GYROSCOPE_ENABLE || QMI8658A_INT_ENABLE)
+#endif
+
+// STOP time between two scans of a held key (ms)
+#ifndef KB_HOLD_STOP_PERIOD
+#define KB_HOLD_STOP_PERIOD                           TASK_PERIOD_KEYBOARD
+#endif
+
+// LPTIM runs from LSI / 32, about 1 ms per count
+#define LPTIM_CLOCK_HZ                                (LSI_VALUE / 32)
 /*============================================================================*
  *                          Functions
  *============================================================================*/
@@ -15,6 +15,7 @@
  *                              Header Files
  *============================================================================*/
 #include "stdint.h"
+#include "string.h"
 #include "433_protocol.h"
 #include "433_send_driver.h"
 
@@ -22,139 +23,106 @@
 /*============================================================================*
  *                              Variables
  *============================================================================*/
-const T_WM_SPEC SPEC =
+#if (WAKE_UP_CODE_LEN != 4)
+#error "wm_prefix[] lists four wake-up bytes"
+#endif
+
+#if (WM_HEADER_LEN < 3 || WM_HEADER_LEN + WM_START_LEN <= 8 || WM_HEADER_LEN + WM_START_LEN > 16)
+#error "header and start bit must fill the last 16 half-bit prefix word"
+#endif
+
+/* Wake-up code, header and start bit as packed half-bits, MSB first, 1 = high.
+ * Only the payload and the low stop run are produced at send time. */
+static const uint8_t wm_prefix[WM_PREFIX_BYTES] =
 {
-    {0xff, 0xff, 0xff, 0xff},   //wake_up_code[WAKE_UP_CODE_LEN];
-    WAKE_UP_CODE_LEN,
-    10,                         //header_len;
-    5                           //stop_len
+    WM_MANCHESTER(WM_WAKE_UP_CODE) >> 8, WM_MANCHESTER(WM_WAKE_UP_CODE) & 0xFF,
+    WM_MANCHESTER(WM_WAKE_UP_CODE) >> 8, WM_MANCHESTER(WM_WAKE_UP_CODE) & 0xFF,
+    WM_MANCHESTER(WM_WAKE_UP_CODE) >> 8, WM_MANCHESTER(WM_WAKE_UP_CODE) & 0xFF,
+    WM_MANCHESTER(WM_WAKE_UP_CODE) >> 8, WM_MANCHESTER(WM_WAKE_UP_CODE) & 0xFF,
+    WM_HEADER_START >> 8, WM_HEADER_START & 0xFF,
 };
 
 /*============================================================================*
  *                              Local Functions
  *============================================================================*/
-// CRC-8多项式：x^8 + x^2 + x + 1 = 0x07
-#define CRC8_POLYNOMIAL 0x07
-
-#define CRC8_INITIAL_VALUE 0x00
-
-// 计算CRC-8值
-uint8_t crc8(uint8_t *data, uint8_t length) {
-    uint8_t crc = CRC8_INITIAL_VALUE; 
-    for (uint8_t i = 0; i < length; i++) {
-        crc ^= data[i];
-        for (uint8_t j = 0; j < 8; j++) {  
-            if (crc & 0x80) {
-                crc = (crc << 1) ^ CRC8_POLYNOMIAL;
-            } else {
-                crc <<= 1;  
-            }
-        }
-        // printf("CRC-8 %d: 0x%02X\n", i,crc);  // 打印CRC结果
+/* Manchester code of one nibble, MSB first: log 1 -> "10", log 0 -> "01" */
+static const uint8_t manchester_nibble[16] =
+{
+    0x55, 0x56, 0x59, 0x5A, 0x65, 0x66, 0x69, 0x6A,
+    0x95, 0x96, 0x99, 0x9A, 0xA5, 0xA6, 0xA9, 0xAA
+};
+
+/******************************************************************
+ * @brief   append n half-bits (MSB first) to the packed wave buffer
+ * @param   T_WM_BUF *p_wm_data_buf
+ * @param   uint16_t bits  right-aligned half-bit levels, 1 = high
+ * @param   uint8_t n      number of half-bits, at most 16
+ * @return  none
+ */
+static void wm_buf_put_bits(T_WM_BUF *p_wm_data_buf, uint16_t bits, uint8_t n)
+{
+    while (n)
+    {
+        uint8_t room = 8 - (p_wm_data_buf->buf_len & 0x07);
+        uint8_t take = (n < room) ? n : room;
+        uint8_t chunk = (bits >> (n - take)) & ((1 << take) - 1);
+
+        p_wm_data_buf->p_buf[p_wm_data_buf->buf_len >> 3] |= chunk << (room - take);
+        p_wm_data_buf->buf_len += take;
+        n -= take;
     }
-    return crc; 
 }
 
 /******************************************************************
- * @brief   bit_n
- * @param   uint32_t a
- * @param   uint32_t b
- * @return  result
- * @retval  uint8_t
+ * @brief   append one byte as 16 Manchester half-bits
+ * @param   T_WM_BUF *p_wm_data_buf
+ * @param   uint8_t code
+ * @return  none
  */
-static uint8_t bit_n(uint32_t a, uint32_t b)
+static void wm_buf_put_byte(T_WM_BUF *p_wm_data_buf, uint8_t code)
 {
-    return ((a >> b) & 0x01);
+    wm_buf_put_bits(p_wm_data_buf,
+                    (manchester_nibble[code >> 4] << 8) | manchester_nibble[code & 0x0F],
+                    16);
 }
 
 /******************************************************************
- * @brief   ir_protocol_nec_command_set_tx_buf
- * @param   T_IR_NEC_BUF *p_ir_data_buf
- * @param   T_IR_NEC_SPEC p_spec
- * @return  result
- * @retval  T_IRDA_RET
+ * @brief   append a run of low half-bits
+ * @param   T_WM_BUF *p_wm_data_buf
+ * @param   uint8_t n
+ * @return  none
+ * @note    the wave buffer is cleared before encoding, so low is a skip
  */
-static T_WMDA_RET protocol_command_set_tx_buf(T_WM_BUF *p_wm_data_buf,
-                                                     T_WM_SPEC *p_spec)
+static void wm_buf_put_low(T_WM_BUF *p_wm_data_buf, uint8_t n)
 {
-    uint8_t i = 0, n = 0;
-    uint16_t  buf_len = 0;
-    uint8_t   Code = 0;
-
-    //Wake-up code
-    for (i = 0; i < p_spec->wake_up_code_len; i++)
-    {
-        Code = p_spec->wake_up_code[i];
-        for (n = 0; n < 8; n++)
-        {
-            /* Change encoding bit order */
-            if (bit_n(Code,7-n)== 0x01)
-            {
-                /* log 1 */
-                p_wm_data_buf->p_buf[buf_len] = LEVEL_HIGH;
-                p_wm_data_buf->p_buf[buf_len + 1] = LEVEL_LOW;
-                buf_len += 2;
-            }
-            else
-            {
-                /* log 0 */
-                p_wm_data_buf->p_buf[buf_len] = LEVEL_LOW;
-                p_wm_data_buf->p_buf[buf_len + 1] = LEVEL_HIGH;
-                buf_len += 2;
-            }
+    p_wm_data_buf->buf_len += n;
+}
 
-        }
-    }
+/******************************************************************
+ * @brief   render the whole frame into the packed wave buffer
+ * @details the prefix is copied from flash, only the payload is encoded.
+ * @param   T_WM_BUF *p_wm_data_buf
+ * @return  result
+ * @retval  T_WMDA_RET
+ */
+static T_WMDA_RET protocol_command_set_tx_buf(T_WM_BUF *p_wm_data_buf)
+{
+    uint8_t i = 0;
+    uint16_t total = WM_PREFIX_LEN + p_wm_data_buf->code_len * 16 + WM_STOP_LEN;
 
-    /* header */
-    for (i = 0; i < p_spec->header_len; i++)
-    {
-        if(i<3)
-            p_wm_data_buf->p_buf[buf_len + i] =  LEVEL_HIGH;
-        else
-            p_wm_data_buf->p_buf[buf_len + i] =  LEVEL_LOW;
+    if (total > WM_SEND_WAVE_MAX_BITS)
+        return IRDA_DATA_ERROR;
 
-    }
-    buf_len += p_spec->header_len;
+    //wake-up code, header, start bit
+    memcpy(p_wm_data_buf->p_buf, wm_prefix, WM_PREFIX_BYTES);
+    p_wm_data_buf->buf_len = WM_PREFIX_LEN;
 
-    //start bit log 1
-    p_wm_data_buf->p_buf[buf_len] = LEVEL_HIGH;
-    p_wm_data_buf->p_buf[buf_len + 1] = LEVEL_LOW;
-    buf_len += 2;
-    
     //code
     for (i = 0; i < p_wm_data_buf->code_len; i++)
-    {
-        Code = p_wm_data_buf->code[i];
-        for (n = 0; n < 8; n++)
-        {
-            /* Change encoding bit order */
-            if (bit_n(Code,7-n)== 0x01)
-            {
-                /* log 1 */
-                p_wm_data_buf->p_buf[buf_len] = LEVEL_HIGH;
-                p_wm_data_buf->p_buf[buf_len + 1] = LEVEL_LOW;
-                buf_len += 2;
-            }
-            else
-            {
-                /* log 0 */
-                p_wm_data_buf->p_buf[buf_len] = LEVEL_LOW;
-                p_wm_data_buf->p_buf[buf_len + 1] = LEVEL_HIGH;
-                buf_len += 2;
-            }
-
-        }
-    }
+        wm_buf_put_byte(p_wm_data_buf, p_wm_data_buf->code[i]);
 
     //stop
-    for (i = 0; i < p_spec->stop_len; i++)
-    {
-        p_wm_data_buf->p_buf[buf_len + i] =  LEVEL_LOW;
-    }
-    buf_len += p_spec->stop_len;
-
-    p_wm_data_buf->buf_len = buf_len;
+    wm_buf_put_low(p_wm_data_buf, WM_STOP_LEN);
 
     return IRDA_SUCCEED;
 }
@@ -178,18 +146,94 @@ T_WMDA_RET protocol_command_encode(uint8_t *data, uint8_t len,
     /* set p_ir_send_buf and send_buf_len */
     T_WM_BUF data_buf;
 
+    if (len > MAX_CODE_SIZE)
+        return IRDA_DATA_ERROR;
+
     data_buf.code_len = len;
-    //memcpy(data_buf.code, data, len);
+    memcpy(data_buf.code, data, len);
 
 
     data_buf.p_buf = p_send_parameters->wm_send_buf;
 
-    ret = protocol_command_set_tx_buf(&data_buf, (T_WM_SPEC *)&SPEC); 
+    ret = protocol_command_set_tx_buf(&data_buf);
     p_send_parameters->send_buf_len = data_buf.buf_len;
 
     return ret;
 }
 
+/******************************************************************
+ * @brief   prepare on-the-fly generation of one frame
+ * @param   uint8_t *data
+ * @param   uint8_t len
+ * @param   T_WM_WAVE *p_wave
+ * @return  result
+ * @retval  T_WMDA_RET
+ */
+T_WMDA_RET protocol_wave_start(uint8_t *data, uint8_t len, T_WM_WAVE *p_wave)
+{
+    if (len > MAX_CODE_SIZE)
+        return IRDA_DATA_ERROR;
+
+    memcpy(p_wave->code, data, len);
+    p_wave->code_len = len;
+    p_wave->phase = WM_PHASE_PREFIX;
+    p_wave->index = 0;
+    p_wave->bit_cnt = 0;
+    p_wave->shift = 0;
+
+    return IRDA_SUCCEED;
+}
+
+/******************************************************************
+ * @brief   load the next run of half-bits into the wave shift register
+ * @details called from the TIM1 ISR once per byte or symbol, so the
+ *          per-half-bit path is only a shift and a pin write.
+ * @param   T_WM_WAVE *p_wave
+ * @return  false when the frame is complete
+ * @retval  bool
+ */
+bool protocol_wave_next_segment(T_WM_WAVE *p_wave)
+{
+    uint8_t code;
+
+    switch (p_wave->phase)
+    {
+    case WM_PHASE_PREFIX:
+        /* wake-up code, then header and start bit in the last word */
+        p_wave->shift = (wm_prefix[p_wave->index] << 8) | wm_prefix[p_wave->index + 1];
+        p_wave->index += 2;
+        if (p_wave->index < WM_PREFIX_BYTES)
+        {
+            p_wave->bit_cnt = 16;
+        }
+        else
+        {
+            p_wave->bit_cnt = WM_PREFIX_LEN - (WM_PREFIX_BYTES - 2) * 8;
+            p_wave->phase = WM_PHASE_CODE;
+            p_wave->index = 0;
+        }
+        return true;
+
+    case WM_PHASE_CODE:
+        if (p_wave->index < p_wave->code_len)
+        {
+            code = p_wave->code[p_wave->index++];
+            p_wave->shift = (manchester_nibble[code >> 4] << 8) | manchester_nibble[code & 0x0F];
+            p_wave->bit_cnt = 16;
+            return true;
+        }
+        /* fall through */
+    case WM_PHASE_STOP:
+        p_wave->shift = 0;
+        p_wave->bit_cnt = WM_STOP_LEN;
+        p_wave->phase = WM_PHASE_DONE;
+        return true;
+
+    default:
+        return false;
+    }
+}
+
 #endif
 
 
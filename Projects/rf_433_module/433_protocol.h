@@ -29,26 +29,67 @@
 #define WAKE_UP_CODE_LEN            4
 #define MAX_CODE_SIZE               9
 
+/* Fixed frame layout, in half-bits of HALF_BIT us */
+#define WM_WAKE_UP_CODE             0xFF        // sent WAKE_UP_CODE_LEN times
+#define WM_HEADER_LEN               10          // 3 high, rest low
+#define WM_START_LEN                2           // log 1
+#define WM_STOP_LEN                 5           // low
+#define WM_PREFIX_LEN               (WAKE_UP_CODE_LEN * 16 + WM_HEADER_LEN + WM_START_LEN)
+#define WM_PREFIX_BYTES             ((WM_PREFIX_LEN + 7) / 8)
+
+/* Manchester code of one byte as 16 half-bits, MSB first, constant folded */
+#define WM_MANCHESTER_BIT(b, n)     (((((b) >> (n)) & 1U) ? 2U : 1U) << (2 * (n)))
+#define WM_MANCHESTER(b)            (WM_MANCHESTER_BIT(b, 7) | WM_MANCHESTER_BIT(b, 6) | \
+                                     WM_MANCHESTER_BIT(b, 5) | WM_MANCHESTER_BIT(b, 4) | \
+                                     WM_MANCHESTER_BIT(b, 3) | WM_MANCHESTER_BIT(b, 2) | \
+                                     WM_MANCHESTER_BIT(b, 1) | WM_MANCHESTER_BIT(b, 0))
+
+/* header and start bit, left aligned in 16 half-bits */
+#define WM_HEADER_START             (((0x7U << (WM_HEADER_LEN - 3 + WM_START_LEN)) | 0x2U) << \
+                                     (16 - WM_HEADER_LEN - WM_START_LEN))
+
+
 typedef struct
 {
-    uint8_t wake_up_code[WAKE_UP_CODE_LEN];
-    uint8_t wake_up_code_len;
-    uint8_t header_len;
-    uint8_t stop_len;
-} T_WM_SPEC;
+    uint8_t code[MAX_CODE_SIZE];
+    uint8_t code_len;
+    uint16_t buf_len;           // half-bits written
+    uint8_t *p_buf;             // packed wave, MSB first, 1 = high
+} T_WM_BUF;
 
+enum
+{
+    WM_PHASE_PREFIX,
+    WM_PHASE_CODE,
+    WM_PHASE_STOP,
+    WM_PHASE_DONE,
+};
+
+typedef struct
+{
+    uint8_t code[MAX_CODE_SIZE];
+    uint8_t len;
+    uint8_t repeat;             // transmissions left, including the one on air
+    uint8_t sent;               // transmissions completed
+} T_WM_FRAME;
 
 typedef struct
 {
     uint8_t code[MAX_CODE_SIZE];
     uint8_t code_len;
-    uint16_t buf_len;
-    uint8_t *p_buf;
-} T_WM_BUF;
+    uint8_t phase;
+    uint8_t index;              // byte index inside the current phase, pairs in the prefix
+    uint8_t bit_cnt;            // half-bits left in shift
+    uint16_t shift;             // pending half-bits, MSB first, 1 = high
+} T_WM_WAVE;
 
 T_WMDA_RET protocol_command_encode(uint8_t *data, uint8_t len,
                                           T_WM_SEND_PARA *p_send_parameters);
 
+T_WMDA_RET protocol_wave_start(uint8_t *data, uint8_t len, T_WM_WAVE *p_wave);
+
+bool protocol_wave_next_segment(T_WM_WAVE *p_wave);
+
 #endif  //UI_RF_ENABLE
 
 #endif
@@ -30,8 +30,32 @@
  *============================================================================*/
 static T_WM_SEND_STRUCT wm_send_struct;
 
+/* Single-producer (rf_send_repeat) / single-consumer (TIM1 ISR) frame queue.
+ * The entry at wm_queue_tail is the frame on air, it is released by the ISR. */
+static T_WM_FRAME wm_queue[RF_SEND_QUEUE_SIZE];
+static volatile uint8_t wm_queue_head = 0;
+static volatile uint8_t wm_queue_tail = 0;
+static volatile uint8_t wm_cancel_head = 0;
+static volatile _Bool wm_cancel = 0;
+
+#if (RF_SEND_ONTHEFLY_ENABLE)
+static T_WM_WAVE wm_wave;
+#else
+static T_WM_SEND_PARA wm_send_parameters;
+static uint16_t wm_bit_index;
+static uint8_t wm_bit_shift;
+#endif
+
+#if (RF_SEND_RUN_LENGTH_ENABLE)
+static uint8_t run_level;       /* level of the run that starts on the next update */
+static uint8_t run_next;        /* first half-bit after that run */
+#endif
+
 static void rf_gpio_config(void);
 static void rf_timer_config(void);
+static void rf_timer_start(void);
+static void rf_timer_stop(void);
+static void rf_frame_load(T_WM_FRAME *p_frame);
 
 /*============================================================================*
  *                              Functions Declaration
@@ -77,6 +101,7 @@ void rf_driver_init(void)
 }
 /**
   * @brief  Initialize tim peripheral.
+  * @note   TIM1 is left stopped with its clock gated, rf_send() starts it.
   * @param  No parameter.
   * @return void
 */
@@ -84,7 +109,7 @@ static void rf_timer_config(void)
 {
   LL_TIM_InitTypeDef TIM1CountInit = {0};
 
-  LL_APB1_GRP2_EnableClock(RCC_APBENR2_TIM1EN);
+  LL_APB1_GRP2_EnableClock(LL_APB1_GRP2_PERIPH_TIM1);
   
   TIM1CountInit.ClockDivision       = LL_TIM_CLOCKDIVISION_DIV1;
   TIM1CountInit.CounterMode         = LL_TIM_COUNTERMODE_UP;
@@ -93,36 +118,199 @@ static void rf_timer_config(void)
   TIM1CountInit.RepetitionCounter   = 0;
   LL_TIM_Init(TIM1, &TIM1CountInit);
 
+  /* run length and frame gap are written while the previous period is on air */
+  LL_TIM_EnableARRPreload(TIM1);
+  LL_TIM_ClearFlag_UPDATE(TIM1);
   LL_TIM_EnableIT_UPDATE(TIM1);
-  LL_TIM_EnableCounter(TIM1);
 
+  NVIC_ClearPendingIRQ(TIM1_BRK_UP_TRG_COM_IRQn);
   NVIC_EnableIRQ(TIM1_BRK_UP_TRG_COM_IRQn);
-  NVIC_SetPriority(TIM1_BRK_UP_TRG_COM_IRQn,0);
+  /* lowest level: the pin is written in software, so a SysTick or key EXTI
+   * handler running at the update delays that edge by its own length. The
+   * counter keeps the period, so the error does not add up over a frame as
+   * long as the handlers are much shorter than HALF_BIT us */
+  NVIC_SetPriority(TIM1_BRK_UP_TRG_COM_IRQn,3);
+
+  LL_APB1_GRP2_DisableClock(LL_APB1_GRP2_PERIPH_TIM1);
+}
+
+/**
+  * @brief  Ungate and start TIM1 for one frame.
+  * @note   The forced update event loads the period and raises the first
+  *         interrupt at once, so the frame starts without waiting a period.
+  * @param  No parameter.
+  * @return void
+*/
+static void rf_timer_start(void)
+{
+  LL_TIM_SetCounter(TIM1, 0);
+  LL_TIM_GenerateEvent_UPDATE(TIM1);
+  LL_TIM_EnableCounter(TIM1);
+}
+
+/**
+  * @brief  Stop TIM1 and gate its clock once the frame is on air.
+  * @param  No parameter.
+  * @return void
+*/
+static void rf_timer_stop(void)
+{
+  LL_TIM_DisableCounter(TIM1);
+  LL_TIM_ClearFlag_UPDATE(TIM1);
+  LL_APB1_GRP2_DisableClock(LL_APB1_GRP2_PERIPH_TIM1);
+}
+
+/**
+  * @brief  Fetch the next half-bit level of the frame being sent.
+  * @param  No parameter.
+  * @return 1 = high, 0 = low, WM_LEVEL_END after the last half-bit
+*/
+static uint8_t rf_wave_next_level(void)
+{
+  uint8_t level;
+
+#if (RF_SEND_ONTHEFLY_ENABLE)
+  if(wm_wave.bit_cnt == 0 && !protocol_wave_next_segment(&wm_wave))
+    return WM_LEVEL_END;
+
+  level = wm_wave.shift >> 15;
+  wm_wave.shift <<= 1;
+  wm_wave.bit_cnt--;
+#else
+  if(wm_bit_index >= wm_send_struct.p_wm_send_data->send_buf_len)
+    return WM_LEVEL_END;
+
+  if((wm_bit_index & 0x07) == 0)
+    wm_bit_shift = wm_send_struct.p_wm_send_data->wm_send_buf[wm_bit_index >> 3];
+
+  level = wm_bit_shift >> 7;
+  wm_bit_shift <<= 1;
+  wm_bit_index++;
+#endif
+
+  return level;
+}
+
+#if (RF_SEND_RUN_LENGTH_ENABLE)
+/**
+  * @brief  Collect the next run of equal half-bits into run_level.
+  * @param  No parameter.
+  * @return run length in half-bits, 0 when the frame is complete
+*/
+static uint8_t rf_run_load(void)
+{
+  uint8_t len = 0;
+
+  run_level = run_next;
+  if(run_level == WM_LEVEL_END)
+    return 0;
+
+  do{
+    len++;
+    run_next = rf_wave_next_level();
+  }while(run_next == run_level && len < RF_RUN_MAX_HALF_BITS);
+
+  return len;
+}
+
+/**
+  * @brief  Program the TIM1 period for a run, taken over at the next update.
+  * @param  len: run length in half-bits, 0 keeps a single half-bit period.
+  * @return void
+*/
+static void rf_run_set_period(uint8_t len)
+{
+  if(len == 0)
+    len = 1;
+  LL_TIM_SetAutoReload(TIM1, len * (HALF_BIT) - 1);
+}
+#endif
+
+/**
+  * @brief  Prepare the wave source and first period for a queued frame.
+  * @note   The period takes effect at the next update event.
+  * @param  p_frame: frame at the queue tail.
+  * @return void
+*/
+static void rf_frame_load(T_WM_FRAME *p_frame)
+{
+#if (RF_SEND_ONTHEFLY_ENABLE)
+  protocol_wave_start(p_frame->code, p_frame->len, &wm_wave);
+#else
+  memset(&wm_send_parameters, 0, sizeof(T_WM_SEND_PARA));
+  protocol_command_encode(p_frame->code, p_frame->len, &wm_send_parameters);
+  wm_send_module_init(&wm_send_parameters);
+  wm_bit_index = 0;
+#endif
+
+#if (RF_SEND_RUN_LENGTH_ENABLE)
+  /* first run is timed from the update that starts the frame */
+  run_next = rf_wave_next_level();
+  rf_run_set_period(rf_run_load());
+#else
+  LL_TIM_SetAutoReload(TIM1, (HALF_BIT) - 1);
+#endif
+}
+
+/**
+  * @brief  Release the finished frame and decide what goes on air next.
+  * @details A frame is repeated until its count runs out. A newer queued frame
+  *          takes over earlier, but not before RF_SEND_MIN_REPEAT repeats of
+  *          the current one are on air.
+  * @param  No parameter.
+  * @return true if another frame is waiting at the queue tail
+*/
+static bool rf_frame_next(void)
+{
+  uint8_t tail = wm_queue_tail;
+
+  if(wm_cancel){
+    wm_cancel = 0;
+    tail = wm_cancel_head;
+  }else if(--wm_queue[tail].repeat == 0 ||
+           (++wm_queue[tail].sent >= RF_SEND_MIN_REPEAT &&
+            ((tail + 1) & (RF_SEND_QUEUE_SIZE - 1)) != wm_queue_head)){
+    tail = (tail + 1) & (RF_SEND_QUEUE_SIZE - 1);
+  }
+
+  wm_queue_tail = tail;
+
+  return (tail != wm_queue_head);
 }
 
 void TIM1_BRK_UP_TRG_COM_IRQHandler(void)
 {
   if(LL_TIM_IsActiveFlag_UPDATE(TIM1) && LL_TIM_IsEnabledIT_UPDATE(TIM1))
   {
-    static uint16_t i = 0;
     LL_TIM_ClearFlag_UPDATE(TIM1);
-    uint8_t level = wm_send_struct.p_wm_send_data->wm_send_buf[i];
 
-    if(wm_send_struct.wm_send_state ==  WM_SEND_CAMMAND_COMPLETE)
-        wm_send_struct.wm_send_state =  WM_SEND_IDLE;
-
-    if(wm_send_struct.wm_send_state == WM_SEND_CAMMAND){
-      if(i < wm_send_struct.p_wm_send_data ->send_buf_len){
-          if(level == LEVEL_HIGH)
+    if(wm_send_struct.wm_send_state == WM_SEND_GAP){
+      /* gap period is running, the next frame starts on the update after it */
+      rf_frame_load(&wm_queue[wm_queue_tail]);
+      wm_send_struct.wm_send_state = WM_SEND_CAMMAND;
+    }else if(wm_send_struct.wm_send_state == WM_SEND_CAMMAND){
+#if (RF_SEND_RUN_LENGTH_ENABLE)
+      /* update fires only at run boundaries: drive this run, time the next */
+      uint8_t level = run_level;
+#else
+      uint8_t level = rf_wave_next_level();
+#endif
+      if(level != WM_LEVEL_END){
+          if(level)
             LL_GPIO_SetOutputPin(GPIOB, LL_GPIO_PIN_7);//HIGH
           else
             LL_GPIO_ResetOutputPin(GPIOB, LL_GPIO_PIN_7);//low
 
-          i++;
+#if (RF_SEND_RUN_LENGTH_ENABLE)
+          rf_run_set_period(rf_run_load());
+#endif
+        }else if(rf_frame_next()){
+          /* back-to-back: hold the line low for the inter-frame gap */
+          wm_send_struct.wm_send_state = WM_SEND_GAP;
+          LL_TIM_SetAutoReload(TIM1, RF_SEND_FRAME_GAP - 1);
         }else{
-          i = 0;
-          wm_send_struct.wm_send_state =  WM_SEND_CAMMAND_COMPLETE;
-          memset(&wm_send_struct, 0, sizeof(T_WM_SEND_STRUCT));
+          rf_timer_stop();
+          memset(&wm_send_struct, 0, sizeof(T_WM_SEND_STRUCT));  /* WM_SEND_IDLE */
         }
     }
   }
@@ -139,8 +327,6 @@ void mw_driver_tx_gdma_init(uint32_t source_addr, uint32_t buffer_size)
    //source_addr :wave buffer
 }
 
-static T_WM_SEND_PARA wm_send_parameters;
-
 /******************************************************************
  * @brief   check if 433 send is working.
  * @param   none
@@ -157,42 +343,69 @@ bool rf_send_is_working(void)
 }
 
 /******************************************************************
- * @brief   get 433 send current state
- * @param   none
- * @return  ir send current state
- * @retval  T_IR_SEND_STATE
+ * @brief   queue a frame to be sent repeat times back-to-back
+ * @details the frame is copied, so the caller may reuse data at once.
+ *          If the transmitter is idle it is started right away, otherwise
+ *          the TIM1 ISR picks the frame up after the current one.
+ * @param   uint8_t *data
+ * @param   uint8_t len
+ * @param   uint8_t repeat
+ * @return  false if the frame is invalid or the queue is full
+ * @retval  _Bool
  */
-T_WM_SEND_STATE rf_send_get_current_state(void)
+_Bool rf_send_repeat(uint8_t *data, uint8_t len, uint8_t repeat)
 {
-    return wm_send_struct.wm_send_state;
-}
+    uint8_t head = wm_queue_head;
+    uint8_t next = (head + 1) & (RF_SEND_QUEUE_SIZE - 1);
 
-/**
-  * @brief  Demo code of operation about timer + gpio.
-  * @param  No parameter.
-  * @return void
-*/
-_Bool rf_send(uint8_t *data, uint8_t len)
-{
-    T_WMDA_RET ret = IRDA_ERROR;
+    if(len > MAX_CODE_SIZE || repeat == 0)
+      return 0;
 
-    if(true == rf_send_is_working()){
-      // printf("[433_RF_ERR] RF send is working, can't start RF send.\r\n");
+    if(next == wm_queue_tail){
+      // printf("[433_RF_ERR] RF send queue is full.\r\n");
       return 0;
     }
 
-    memset(&wm_send_parameters, 0, sizeof(T_WM_SEND_PARA));
+    memcpy(wm_queue[head].code, data, len);
+    wm_queue[head].len = len;
+    wm_queue[head].repeat = repeat;
+    wm_queue[head].sent = 0;
+    __DMB();
+    wm_queue_head = next;
+
+    if(false == rf_send_is_working()){
+      wm_cancel = 0;
+      LL_APB1_GRP2_EnableClock(LL_APB1_GRP2_PERIPH_TIM1);
+      rf_frame_load(&wm_queue[wm_queue_tail]);
+      wm_send_struct.wm_send_state = WM_SEND_CAMMAND;
+      rf_timer_start();
+    }
+    return 1;
+}
 
-    ret = protocol_command_encode(data, len, &wm_send_parameters);
+/******************************************************************
+ * @brief   queue a single frame
+ * @param   uint8_t *data
+ * @param   uint8_t len
+ * @return  false if the frame is invalid or the queue is full
+ * @retval  _Bool
+ */
+_Bool rf_send(uint8_t *data, uint8_t len)
+{
+    return rf_send_repeat(data, len, 1);
+}
 
-    if(ret == IRDA_SUCCEED){
-    
-      if(true == wm_send_module_init(&wm_send_parameters)){
-        wm_send_struct.wm_send_state = WM_SEND_CAMMAND;
-        // printf("[433_RF]:wave_len:%d...\r\n",wm_send_struct.p_wm_send_data ->send_buf_len);
-      }
-  }
-  return 1;
+/******************************************************************
+ * @brief   drop the remaining repeats and every frame queued so far
+ * @details the frame on air is finished first, frames queued after
+ *          this call are kept.
+ * @param   none
+ * @return  none
+ */
+void rf_send_cancel(void)
+{
+    wm_cancel_head = wm_queue_head;
+    wm_cancel = 1;
 }
 
 bool wm_send_module_init(T_WM_SEND_PARA *p_wm_send_para)
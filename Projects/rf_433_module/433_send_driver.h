@@ -27,10 +27,39 @@ extern "C" {
 /*============================================================================*
  *                          MW Send config
  *============================================================================*/
-#define WM_SEND_WAVE_MAX_LEN            224
+// 1: TIM1 ISR generates the half-bits from the frame bytes, no wave buffer
+// 0: frame is pre-rendered into the packed wave buffer by rf_send()
+#define RF_SEND_ONTHEFLY_ENABLE         1
+
+// 1: TIM1 update fires only at level changes, its period is reloaded per run
+// 0: TIM1 update fires every half-bit
+// Still one interrupt per run, about 170 per frame: the PY32F002B has no DMA
+// to burst the periods into TIM1, so the ISR runs at the lowest priority and
+// only has to reload ARR before the run on air ends
+#define RF_SEND_RUN_LENGTH_ENABLE       1
+#define RF_RUN_MAX_HALF_BITS            16
+
+#define WM_LEVEL_END                    0xFF
+
+// Frames waiting for air, must be a power of two
+#define RF_SEND_QUEUE_SIZE              4
+
+// A newer queued frame takes over only after this many repeats of the frame
+// on air, or when its repeats run out. A key frame is ~92 ms on air with its
+// gap, so a second key waits up to RF_SEND_MIN_REPEAT frames; the first key
+// keeps at least that many copies against a lost frame. 1 waits one frame,
+// RF_SINGLE_SEND_DATA_NUM never preempts a key burst.
+#ifndef RF_SEND_MIN_REPEAT
+#define RF_SEND_MIN_REPEAT              2
+#endif
+
+#ifndef RF_SEND_FRAME_GAP
+#define RF_SEND_FRAME_GAP               2000    // us of idle line between back-to-back frames
+#endif
 
-#define LEVEL_HIGH                      ((uint8_t)0xff)
-#define LEVEL_LOW                       0x0
+// One bit per half-bit period: 4B wake-up + 10 header + 2 start + 9B code + 5 stop = 225
+#define WM_SEND_WAVE_MAX_BITS           232
+#define WM_SEND_WAVE_MAX_LEN            (WM_SEND_WAVE_MAX_BITS / 8)
 
 enum {
     DATA_RESERVE,
@@ -42,7 +71,7 @@ typedef enum
 {
     WM_SEND_IDLE,
     WM_SEND_CAMMAND,
-    WM_SEND_CAMMAND_COMPLETE,
+    WM_SEND_GAP,
 } T_WM_SEND_STATE;
 
 typedef enum
@@ -55,8 +84,8 @@ typedef enum
 
 typedef struct
 {
-    uint8_t wm_send_buf[WM_SEND_WAVE_MAX_LEN];
-    uint16_t send_buf_len;
+    uint8_t wm_send_buf[WM_SEND_WAVE_MAX_LEN];  /* packed half-bit levels, MSB first */
+    uint16_t send_buf_len;                      /* number of half-bits */
 } T_WM_SEND_PARA;
 
 typedef struct
@@ -65,7 +94,11 @@ typedef struct
     T_WM_SEND_PARA   *p_wm_send_data;
 } T_WM_SEND_STRUCT;
 
-_Bool rf_send(uint8_t *data, uint8_t type);
+_Bool rf_send(uint8_t *data, uint8_t len);
+
+_Bool rf_send_repeat(uint8_t *data, uint8_t len, uint8_t repeat);
+
+void rf_send_cancel(void);
 
 bool wm_send_module_init(T_WM_SEND_PARA *p_wm_send_para);
 
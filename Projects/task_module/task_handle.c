@@ -0,0 +1,150 @@
+/*********************************************************************************************************
+ * @file      task_handle.c
+ *
+ * @details   Cooperative tick-driven task scheduler. Every task in the table has a period,
+ *            a deadline on the millisecond timebase and a ready flag that interrupts can set.
+ *            When nothing is due the core waits in WFI. This is not tickless: the 1 ms
+ *            SysTick wakes it every millisecond to recheck the deadline. Longer sleeps
+ *            are left to the power module's STOP mode.
+ *
+ * @author    huzhuohuan
+ * @date      2025-03-20
+ * @version   V_1.0
+ ********************************************************************************************************/
+
+/*============================================================================*
+ *                              Header Files
+ *============================================================================*/
+#include "task_handle.h"
+
+/*============================================================================*
+ *                              Global Variables
+ *============================================================================*/
+static Task_item_t *task_list = 0;
+static uint8_t task_num = 0;
+static volatile _Bool task_wakeup = 0;
+
+/*============================================================================*
+ *                              Function Definitions
+ *============================================================================*/
+/**
+ * @brief  Registers the task table used by the scheduler.
+ * @param  list: Pointer to the static task table.
+ * @param  num: Number of entries in the table.
+ * @retval None
+ */
+void task_scheduler_init(Task_item_t *list, uint8_t num)
+{
+    uint32_t now = clock_time_ms();
+
+    task_list = list;
+    task_num = num;
+
+    for (uint8_t i = 0; i < task_num; i++)
+        task_list[i].deadline = now;
+}
+
+/**
+ * @brief  Marks a task ready so it runs on the next scheduler pass.
+ * @note   Safe to call from interrupt context.
+ * @param  task_id: Index of the task in the table.
+ * @retval None
+ */
+void task_set_ready(uint8_t task_id)
+{
+    if (task_id < task_num)
+    {
+        task_list[task_id].ready = 1;
+        task_wakeup = 1;
+    }
+}
+
+/**
+ * @brief  Changes the period of a task.
+ * @details Switching to TASK_PERIOD_EVENT parks the task until the next
+ *          task_set_ready(); switching back schedules it one period from now.
+ * @note   Safe to call from interrupt context.
+ * @param  task_id: Index of the task in the table.
+ * @param  period_ms: New period, or TASK_PERIOD_EVENT.
+ * @retval None
+ */
+void task_set_period(uint8_t task_id, uint16_t period_ms)
+{
+    if (task_id < task_num)
+    {
+        uint32_t primask = __get_PRIMASK();
+
+        __disable_irq();
+        task_list[task_id].deadline = clock_time_ms() + period_ms;
+        task_list[task_id].period_ms = period_ms;
+        __set_PRIMASK(primask);
+    }
+}
+
+/**
+ * @brief  Executes a single task and records its runtime.
+ * @param  item: Pointer to the task entry.
+ * @retval None
+ */
+static void task_execute(Task_item_t *item)
+{
+#if (TASK_RUNTIME_STAT_ENABLE)
+    uint32_t start = clock_time();
+
+    item->task();
+
+    uint32_t cost = clock_time() - start;
+    item->run_cnt++;
+    item->run_time_us += cost;
+    if (cost > item->run_time_max_us)
+        item->run_time_max_us = cost;
+#else
+    item->task();
+#endif
+}
+
+/**
+ * @brief  Runs one scheduler pass and idles until the next task is due.
+ * @details Tasks whose deadline has passed or that were marked ready are
+ *          executed in table order. The core then waits in WFI, waking on
+ *          every 1 ms SysTick to compare the time with the earliest remaining
+ *          deadline; any task_set_ready() call from an interrupt ends the wait
+ *          early.
+ * @retval None
+ */
+void task_scheduler_run(void)
+{
+    uint32_t now = clock_time_ms();
+    uint32_t next = now + TASK_IDLE_MAX_SLEEP;
+
+    task_wakeup = 0;
+
+    for (uint8_t i = 0; i < task_num; i++)
+    {
+        Task_item_t *item = &task_list[i];
+
+        if (item->period_ms && (int32_t)(now - item->deadline) >= 0)
+            item->ready = 1;
+
+        if (item->ready)
+        {
+            item->ready = 0;
+            if (item->period_ms)
+                item->deadline = now + item->period_ms;
+            task_execute(item);
+        }
+
+        if (item->period_ms && (int32_t)(item->deadline - next) < 0)
+            next = item->deadline;
+    }
+
+    // Sleep with interrupts masked so a wakeup between the check and WFI is not lost
+    __disable_irq();
+    while (!task_wakeup && (int32_t)(next - clock_time_ms()) > 0)
+    {
+        __WFI();
+        __enable_irq();
+        __disable_irq();
+    }
+    __enable_irq();
+}
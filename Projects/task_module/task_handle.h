@@ -0,0 +1,62 @@
+/*********************************************************************************************************
+ *               Copyright(c) 2024, Seneasy Corporation. All rights reserved.
+ **********************************************************************************************************
+ * @file     task_handle.h
+ * @brief
+ * @details
+ * @author   huzhuohuan
+ * @date     2025-03-20
+ * @version  V_1.0
+ *********************************************************************************************************/
+
+#ifndef _TASK_HANDLE_H_
+#define _TASK_HANDLE_H_
+
+/*============================================================================*
+ *                              Header Files
+ *============================================================================*/
+#include "main.h"
+#include "app.h"
+
+/*============================================================================*
+ *                        Export Global Variables
+ *============================================================================*/
+#ifndef TASK_RUNTIME_STAT_ENABLE
+#define TASK_RUNTIME_STAT_ENABLE                0
+#endif
+
+// Longest idle wait when no periodic task is pending (ms), in 1 ms SysTick wakeups
+#define TASK_IDLE_MAX_SLEEP                     1000
+
+// Period 0: the task only runs after task_set_ready()
+#define TASK_PERIOD_EVENT                       0
+
+typedef void (*Task_func)(void);
+
+typedef struct
+{
+    Task_func task;
+    uint16_t period_ms;
+    volatile _Bool ready;
+    uint32_t deadline;
+#if (TASK_RUNTIME_STAT_ENABLE)
+    uint32_t run_cnt;
+    uint32_t run_time_us;
+    uint32_t run_time_max_us;
+#endif
+} Task_item_t;
+
+#define TASK_ITEM(func, period)                 {(func), (period), 1, 0}
+
+/*============================================================================*
+ *                          Functions
+ *============================================================================*/
+
+/*============================================================================*
+ *                      Extern Functions
+ *============================================================================*/
+extern void task_scheduler_init(Task_item_t *list, uint8_t num);
+extern void task_scheduler_run(void);
+extern void task_set_ready(uint8_t task_id);
+extern void task_set_period(uint8_t task_id, uint16_t period_ms);
+#endif